@@ -22,6 +22,12 @@
 
 #include <GL/glew.h>
 #include <GL/freeglut.h>
+#ifdef POK3DEX_HEADLESS_EGL         // Set by CMake when EGL is found (Linux)
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 #include <AL/al.h>
 #include <AL/alc.h>
 #include <ft2build.h>
@@ -39,8 +45,19 @@
 #include <chrono>          // For high_resolution_clock
 #include <tiny_gltf.h>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <unordered_map>
+#include <future>           // For std::async texture decoding
+#include <cstring>          // For memcpy
+#include <cmath>
+#include <cstdint>          // For fixed-size manifest fields
+#include <functional>
+#include <thread>           // Capture encoder thread
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
 
 // ===============================
 // Pok3Dex Main Game Source File
@@ -66,14 +83,21 @@ const int WIDTH = 1280;  // Window width in pixels
 const int HEIGHT = 720;  // Window height in pixels
 
 // Animation and timing constants
-const float FLASH_SPEED = 0.02f;        // Controls how fast text flashes (higher = faster)
+const float FLASH_SPEED = 1.2f;         // Controls how fast text flashes (higher = faster, per second)
 const int TIMER_LIMIT = 60;             // Time limit for each guess in seconds
 const float COLOR_REVEAL_TIME = 1.5f;   // How long the color reveal animation lasts
+const glm::vec3 SILHOUETTE_COLOR(0.05f, 0.05f, 0.08f);  // Flat colour of the unrevealed model
+const float MODEL_Y_OFFSET = -0.02f;    // Turntable drop below the camera target (world units)
+const float ROTATION_SPEED = 60.0f;     // Model turntable speed (degrees per second)
+const float MAX_FRAME_DELTA = 0.1f;     // Longest step animations take after a stall (seconds)
 
 // Game states - Used to control game flow
-enum GameState { START_SCREEN, NAME_ENTRY, PLAYING, GAME_OVER, WIN_SCREEN };
+enum GameState { START_SCREEN, NAME_ENTRY, PLAYING, GAME_OVER, WIN_SCREEN, GALLERY };
 GameState gameState = START_SCREEN;
 
+// Render queue layers, drawn in this order (see submitRenderQueue)
+enum RenderLayer { RENDER_LAYER_BACKGROUND, RENDER_LAYER_MODEL, RENDER_LAYER_SPRITES, RENDER_LAYER_TEXT };
+
 // Function declarations
 void playSound(ALuint source);
 void drawStartScreen();
@@ -83,7 +107,14 @@ void drawWinScreen();
 void drawGameOverScreen();
 void drawInputBox();
 void loadModel(int id);
+void cancelModelStream();
+void unloadModel(int id);
+void buildImpostorAtlas(int id);
+void flushText();
+void flushSprites(RenderLayer layer = RENDER_LAYER_SPRITES);
+void renderText(const std::string& text, float x, float y, float scale, glm::vec3 color, float alpha = 1.0f);
 void checkGuess();
+void startRoundTimer();
 void initializePokemonSequence();
 int getNextPokemonID();
 
@@ -199,17 +230,21 @@ int getNextPokemonID() {
 
 // Structures
 struct Character {
-    GLuint textureID;
-    glm::ivec2 size;
-    glm::ivec2 bearing;
-    unsigned int advance;
+    glm::ivec2 size = glm::ivec2(0);
+    glm::ivec2 bearing = glm::ivec2(0);
+    unsigned int advance = 0;
+    glm::ivec2 cellSize = glm::ivec2(0);  // Padded SDF cell, in FONT_PIXEL_SIZE pixels
+    glm::vec2 uvMin = glm::vec2(0.0f), uvMax = glm::vec2(0.0f);  // Cell rectangle in the atlas
+    uint32_t codepoint = 0;
+    int shelf = -1;                       // Atlas shelf holding the cell (-1 = no pixels)
+    unsigned int lastUsed = 0;            // Text frame the glyph was last drawn in
 };
-std::map<char, Character> characters;
+bool fontLoaded = false;
 
 struct MeshData {
-    GLuint vao, vbo, ibo, tbo, nbo;
-    size_t indexCount;
-    int materialIndex;
+    GLuint vao = 0, vbo = 0, ibo = 0, tbo = 0, nbo = 0;  // tbo/nbo arrive with phase two
+    size_t indexCount = 0;
+    int materialIndex = -1;
 };
 struct ModelData {
     std::vector<MeshData> meshes;
@@ -218,9 +253,80 @@ struct ModelData {
     std::unique_ptr<Assimp::Importer> importer;
     const aiScene* scene = nullptr;
     std::vector<aiMaterial*> materials;
+    float boundsRadius = 0.0f;   // Bounding sphere radius; loadModel centres models on the origin
 };
 std::unordered_map<int, ModelData> pokemonModels;
 
+// Geometry-first loading - loadModel uploads positions and indices only, which is all the
+// silhouette needs. Texcoords, normals and diffuse textures are prepared on worker threads
+// and attached by pumpModelStream during the round; finishModelStream completes them
+// before the colour reveal.
+struct DecodedTexture {
+    int slot = -1;                    // Ring slot holding the bottom-up pixels, or -1
+    unsigned char* pixels = nullptr;  // Without a slot: stbi-allocated, already bottom-up
+    int w = 0, h = 0;
+    double decodeMs = 0.0;            // Worker time spent in stbi_load
+};
+struct MeshAttributes {
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+};
+struct ModelStream {
+    int id = 0;
+    bool active = false;
+    std::vector<std::string> texturePaths;
+    std::vector<std::future<DecodedTexture>> textures;  // One per material (invalid = no texture)
+    std::vector<int> slots;                              // Ring slot reserved for each job, or -1
+    size_t nextTexture = 0;
+    std::future<std::vector<MeshAttributes>> attributes;
+    bool attributesUploaded = false;
+    std::chrono::high_resolution_clock::time_point start;
+};
+ModelStream modelStream;
+
+// Per-stage cost of the most recent model load, reset by loadModel (read by the benchmark)
+struct ModelLoadStats {
+    double importMs = 0.0;        // Assimp ReadFile
+    double geometryMs = 0.0;      // Bounds, index flattening and position/IBO upload
+    double attributesMs = 0.0;    // Texcoord/normal upload (prepared on a worker)
+    double decodeMs = 0.0;        // Texture decoding, summed over workers
+    double uploadMs = 0.0;        // Texture uploads on the render thread
+    uint64_t textureBytes = 0;    // GPU texture memory including mipmaps
+};
+ModelLoadStats modelLoadStats;
+
+// One species in the headless benchmark (--headless)
+struct BenchResult {
+    int id = 0;
+    ModelLoadStats load;
+    double silhouetteMs = 0.0;    // loadModel return (phase one)
+    double fullMs = 0.0;          // Phase two complete
+    size_t triangles = 0;
+    size_t meshes = 0;
+    unsigned int drawCalls = 0;   // Whole frame, UI included
+    double meanFrameMs = 0.0;
+    double p99FrameMs = 0.0;
+};
+
+// Asset manifest - per-species cost statistics generated offline with --build-manifest.
+// Lets loadModel reserve its buffers up front and startModelStream skip ring slots for
+// textures that are missing or too large to stage through one.
+const char* MANIFEST_BIN_PATH = "assets/models/manifest.bin";
+const char* MANIFEST_TXT_PATH = "assets/models/manifest.txt";
+const uint32_t MANIFEST_MAGIC = 0x464D4B50;  // "PKMF"
+const uint32_t MANIFEST_VERSION = 1;
+struct ModelManifestEntry {
+    uint32_t id = 0;
+    uint32_t meshCount = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t materialCount = 0;
+    uint64_t cpuBytes = 0;                   // Estimated peak CPU memory while loading
+    uint64_t gpuBytes = 0;                   // Estimated GPU memory once resident
+    std::vector<glm::ivec2> textureSizes;    // Diffuse texture size per material (0x0 = none)
+};
+std::unordered_map<int, ModelManifestEntry> modelManifest;
+
 // Remove tinygltf::Model currentModel since we're using Assimp
 struct Texture {
     GLuint id;
@@ -230,8 +336,8 @@ struct Texture {
 Texture startBg, gameBg, pokeballTex;
 
 // Sound
-ALCdevice* alDevice;
-ALCcontext* alContext;
+ALCdevice* alDevice = nullptr;
+ALCcontext* alContext = nullptr;
 ALuint bgmSource, successSource, failureSource, gameBgmSource, gameOverSource, winnerBgmSource;
 
 // ===== GAME STATE VARIABLES =====
@@ -253,9 +359,19 @@ bool modelLoaded = false;    // Tracks if current model is loaded
 // Game timing
 int remainingTime = TIMER_LIMIT;    // Time remaining for current guess
 bool isColorReveal = false;         // Whether color reveal is active
-float colorRevealTimer = 0.0f;      // Tracks color reveal animation progress
+float colorRevealTimer = 0.0f;      // Tracks color reveal animation progress (seconds)
 bool isSilhouette = true;           // Whether model is in silhouette mode
 
+// Game clock - update() advances animations by the measured steady_clock delta, and the
+// guess timer and colour reveal are measured against absolute start/deadline times, so
+// gameplay runs at the same speed at 30, 60 or 144 Hz and when frames are late.
+using GameClock = std::chrono::steady_clock;
+GameClock::time_point lastUpdateTime;
+GameClock::time_point roundDeadline;    // When the current guess runs out of time
+GameClock::time_point revealStartTime;  // When the colour reveal began
+float frameDelta = 0.0f;                // Seconds since the previous update (at most MAX_FRAME_DELTA)
+int targetFps = 60;                     // --fps N; 0 = uncapped, vsync (if on) paces the swaps
+
 // ===== RENDERING SETTINGS =====
 // These settings control how the game looks
 // Modify these to change visual appearance
@@ -265,8 +381,448 @@ const int TEXTURE_POOL_SIZE = 100;  // Maximum number of textures
 GLuint texturePool[TEXTURE_POOL_SIZE];
 int nextTexturePoolIndex = 0;
 
+// Pixel upload ring - persistently mapped pixel-unpack buffer split into fixed slots.
+// Decode threads write pixels straight into a slot and the render thread uploads from
+// the slot offset, so glTexSubImage2D does not copy from client memory.
+const int PBO_RING_SLOTS = 4;                              // Uploads that can be in flight at once
+const size_t PBO_RING_SLOT_BYTES = 2048 * 2048 * 4;        // Largest RGBA image a slot can hold
+struct PboRing {
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    GLsync fences[PBO_RING_SLOTS] = {};  // Signalled once the GPU has read the slot
+    bool reserved[PBO_RING_SLOTS] = {};  // Handed to a decode worker, not uploaded yet
+    int next = 0;
+};
+PboRing pboRing;
+bool usePboRing = true;              // Pass --no-pbo-ring to upload straight from client memory
+// Resource backend - on GL 4.5 (or ARB_direct_state_access with buffer/texture storage) model
+// buffers, VAOs, textures and the font atlas are created with DSA and immutable storage;
+// otherwise, or with --no-dsa, they use the GL 3.3 bind-to-edit path.
+bool useDirectStateAccess = true;
+double textureUploadStallMs = 0.0;   // Render-thread time spent waiting on/issuing texture uploads
+
+// Frame capture - F12 saves a screenshot, F11 starts/stops a frame sequence. The frame is
+// read back into a ring of pixel-pack buffers, collected once its fence has signalled (a
+// frame or two later) and encoded to PNG on a worker thread, so the game never waits on
+// glReadPixels or the encoder.
+const int CAPTURE_SLOTS = 3;
+struct CaptureSlot {
+    GLuint pbo = 0;
+    GLsync fence = nullptr;      // Set while a readback is in flight
+    std::string path;
+    bool announce = false;       // Log the saved file (screenshots, not sequence frames)
+};
+struct CaptureJob {
+    std::string path;
+    int width = 0, height = 0;
+    bool announce = false;
+    std::vector<unsigned char> pixels;
+};
+struct FrameCapture {
+    CaptureSlot slots[CAPTURE_SLOTS];
+    int next = 0;
+    bool screenshotRequested = false;
+    int sequenceRemaining = 0;   // Frames left in the running sequence
+    int sequenceFrame = 0;
+    std::string sequenceName;    // Path prefix of the running sequence
+    int dropped = 0;             // Frames skipped because every slot was in flight
+    std::thread worker;
+    std::mutex mutex;            // Guards jobs and stopping
+    std::condition_variable wake;
+    std::deque<CaptureJob> jobs;
+    bool stopping = false;
+};
+FrameCapture frameCapture;
+std::string captureDir = "captures";   // --capture-dir
+int captureSequenceFrames = 300;       // --capture-frames, length of an F11 sequence
+
 // Shader helpers
-GLuint shaderProgram;
+// A linked program plus its uniform locations, resolved once right after linking
+struct ShaderProgram {
+    GLuint id = 0;
+    std::unordered_map<std::string, GLint> uniforms;
+    GLint uniform(const std::string& name) const {
+        auto it = uniforms.find(name);
+        return it == uniforms.end() ? -1 : it->second;
+    }
+};
+struct ShaderStage {
+    GLenum type;
+    const char* path;
+};
+
+// Program binary cache - linked programs are saved next to their shaders and reloaded with
+// glProgramBinary while the sources, GL vendor/renderer/version and binary format match.
+// Disabled with --no-shader-cache or when the driver offers no binary formats.
+const char* PROGRAM_CACHE_SUFFIX = ".progbin";
+const uint32_t PROGRAM_CACHE_MAGIC = 0x4E494250;  // "PBIN"
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+struct ProgramCacheHeader {
+    uint32_t magic = PROGRAM_CACHE_MAGIC;
+    uint32_t version = PROGRAM_CACHE_VERSION;
+    uint64_t sourceHash = 0;          // FNV-1a of every stage's type and source
+    uint64_t driverHash = 0;          // FNV-1a of GL_VENDOR, GL_RENDERER and GL_VERSION
+    GLenum binaryFormat = 0;
+    uint32_t binaryLength = 0;        // Bytes of binary following the header
+};
+bool useProgramBinaryCache = true;
+uint64_t programCacheDriverHash = 0;
+std::vector<GLenum> programBinaryFormats;
+
+// Shader permutations - one vertex/fragment source pair is specialized into variants by a
+// feature bitmask; bit i adds "#define features[i] 1" to both stages. Variants are built on
+// first use (and kept), or up front with warmShaderVariants, and picked per draw by mask.
+struct ShaderPermutations {
+    const char* vertexPath;
+    const char* fragmentPath;
+    std::vector<std::string> features;
+    void (*onCreate)(const ShaderProgram&) = nullptr;   // Sets constant uniforms of a new variant
+    std::unordered_map<uint32_t, ShaderProgram> variants;
+    bool warmed = false;                                // Later builds are logged as hitches
+};
+enum ModelShaderFeature : uint32_t {
+    MODEL_SHADER_TEXTURED = 1 << 0,   // Sample the material texture (else flat silhouette)
+    MODEL_SHADER_REVEAL = 1 << 1,     // Blend the texture over the silhouette by "reveal"
+};
+void setupModelVariant(const ShaderProgram& variant);
+ShaderPermutations modelShaders = {
+    "shaders/vertex.glsl", "shaders/fragment.glsl", { "TEXTURED", "REVEAL" }, setupModelVariant, {}, false
+};
+
+// Render queue - draws are collected as packets and submitted sorted by a 64-bit key
+// (layer, program, texture, VAO) with redundant state changes skipped. Immediate GL work
+// that queued draws depend on (render target switches, glyph evictions, refilling a
+// stream buffer) submits the queue first.
+struct RenderPacket {
+    uint64_t key = 0;
+    GLuint program = 0, texture = 0, vao = 0;   // texture 0 = whatever is bound
+    bool depthTest = false, blend = false;
+    bool indexed = false;
+    GLint first = 0;             // First vertex, or byte offset into the IBO when indexed
+    GLsizei count = 0;
+    const ShaderProgram* shader = nullptr;   // Set with hasModel, for its uniform locations
+    bool hasModel = false;       // Model shader uniforms below are set before the draw
+    glm::mat4 model;
+    float reveal = 1.0f;
+};
+std::vector<RenderPacket> renderQueue;
+struct RenderQueueStats {
+    int packets = 0;
+    int naive = 0;               // Every state set for every draw
+    int inOrder = 0;             // Filtered, in submission order
+    int issued = 0;              // Filtered after sorting (what is actually sent)
+};
+RenderQueueStats renderQueueStats;   // Accumulated until --frame-stats reports it
+
+// Text rendering - all glyphs live in one signed-distance-field atlas and every string of
+// the frame is appended to a CPU vertex array that flushText draws in a single call.
+// Layout metrics stay in FONT_PIXEL_SIZE units; the SDF is stored at a lower resolution
+// and stays sharp at every scale the screens use (0.6x-2.0x).
+const int FONT_PIXEL_SIZE = 64;       // Rasterization size of the font (layout units)
+const int FONT_SDF_DOWNSAMPLE = 3;    // SDF texels are this many source pixels wide
+const int FONT_SDF_SPREAD = 3;        // Distance range encoded around each edge (SDF texels)
+const int FONT_ATLAS_WIDTH = 512;     // Atlas width in texels (height grows to fit)
+struct TextVertex {
+    glm::vec2 pos;
+    glm::vec2 uv;
+    glm::vec4 color;
+};
+ShaderProgram textProgram;
+GLuint fontAtlas = 0;
+GLuint textVao = 0, textVbo = 0;
+size_t textVboCapacity = 0;
+std::vector<TextVertex> textVertices;
+
+// Sprite batching - backgrounds and UI panels are queued as screen-space quads (same vertex
+// layout as text) and drawn by flushSprites, sorted by layer and texture, so no screen
+// needs the fixed-function pipeline and the window can use a core profile context.
+struct Sprite {
+    GLuint texture = 0;
+    int layer = 0;
+    TextVertex vertices[6];
+};
+ShaderProgram spriteProgram;
+GLuint spriteVao = 0, spriteVbo = 0;
+size_t spriteVboCapacity = 0;
+GLuint whiteTexture = 0;              // 1x1 white texel for solid-colour quads
+std::vector<Sprite> queuedSprites;
+std::vector<TextVertex> spriteVertices;
+
+// Cached 2D layers - backgrounds and fixed labels are rendered once into an offscreen
+// colour buffer and copied to the window with a single blit each frame, so only the
+// model and the changing HUD text are drawn per frame.
+struct CachedLayer {
+    GLuint fbo = 0;
+    GLuint color = 0;
+    std::string key;                  // Content the layer was last rendered for
+    unsigned int fontGeneration = 0;
+    bool valid = false;
+};
+CachedLayer startLayer, gameLayer;
+bool useCachedLayers = true;          // Pass --no-layer-cache to redraw static layers every frame
+
+// Impostors (--impostors, for low-end GPUs and software rasterizers) - the model only spins
+// around Y in front of a fixed camera, so once it is fully loaded IMPOSTOR_VIEWS turntable
+// views are rendered into one atlas and each frame draws the nearest view as a single quad.
+const int IMPOSTOR_VIEWS = 64;
+const int IMPOSTOR_GRID = 8;          // Views per atlas row (IMPOSTOR_GRID^2 >= IMPOSTOR_VIEWS)
+const int IMPOSTOR_CELL = 256;        // Atlas texels per view
+const int IMPOSTOR_REGION = 480;      // Window pixels covered by a view, centred on the model
+struct ImpostorAtlas {
+    GLuint fbo = 0, color = 0, depth = 0;
+    GLuint vao = 0, vbo = 0;
+    int modelId = -1;                 // Model the atlas currently holds (-1 = none)
+    glm::vec2 screenMin = glm::vec2(0.0f);  // Bottom-left of the covered window region
+};
+ImpostorAtlas impostor;
+ShaderProgram impostorProgram;
+bool useImpostors = false;
+
+// Dynamic resolution (--dynamic-resolution, for software-rasterized kiosks) - the model pass
+// renders offscreen at 50-100% of the window size, picked by a controller that keeps the
+// pass's measured GPU time under --gpu-budget, and is upscaled with bilinear filtering
+// underneath the UI, which stays at native resolution.
+const float DYNRES_MIN_SCALE = 0.5f;
+const float DYNRES_MAX_SCALE = 1.0f;
+const float DYNRES_STEP = 0.05f;          // Scale changes in these increments
+const int DYNRES_INTERVAL = 15;           // Frames between controller decisions
+struct DynamicResolution {
+    GLuint fbo = 0, color = 0, depth = 0;
+    GLuint vao = 0, vbo = 0;              // Composite quad
+    float scale = 1.0f;
+    float quadScale = -1.0f;              // Scale the composite quad was built for
+    double smoothedMs = -1.0;             // Model pass GPU time (-1 = no sample yet)
+    int framesSinceChange = 0;
+};
+DynamicResolution dynamicResolution;
+bool useDynamicResolution = false;
+double gpuBudgetMs = 6.0;                 // Model pass GPU budget (--gpu-budget)
+
+// Frame timing - pass --frame-stats to print the average frame interval every 300 frames
+bool showFrameStats = false;
+double frameStatsMs = 0.0;
+int frameStatsCount = 0;
+std::chrono::high_resolution_clock::time_point lastFrameTime;
+
+// Profiler - CPU time of each frame phase (scoped timers) and GPU time of the drawing
+// phases (GL_TIME_ELAPSED queries, double-buffered so results are read a frame late
+// without stalling). F3 toggles the overlay; --profile-csv <file> logs every frame.
+enum ProfilePhase { PHASE_UPDATE, PHASE_LAYERS, PHASE_MODEL, PHASE_SPRITES, PHASE_TEXT, PHASE_SUBMIT, PHASE_SWAP, PHASE_COUNT };
+const char* PROFILE_PHASE_NAMES[PHASE_COUNT] = { "update", "layers", "model", "sprites", "text", "submit", "swap" };
+const int PROFILE_HISTORY = 120;      // Frames in the rolling average/maximum
+struct Profiler {
+    bool gpuTimers = false;           // Timer queries need a current context (set in main)
+    GLuint queries[2][PHASE_COUNT] = {};
+    bool issued[2][PHASE_COUNT] = {};
+    int set = 0;                      // Query set used by the current frame
+    int activeGpuPhase = -1;          // GL_TIME_ELAPSED queries cannot nest
+    double cpuFrame[PHASE_COUNT] = {};
+    double cpuPrevious[PHASE_COUNT] = {};
+    float cpuHistory[PHASE_COUNT][PROFILE_HISTORY] = {};
+    float gpuHistory[PHASE_COUNT][PROFILE_HISTORY] = {};  // -1 = no result for that frame
+    int historyNext = 0;
+    int historyCount = 0;
+    long long frame = 0;
+    std::ofstream csv;
+};
+Profiler profiler;
+bool showProfiler = false;
+unsigned int frameDrawCalls = 0;   // Draw calls issued by the current frame (reset by display)
+struct ProfileScope {
+    ProfilePhase phase;
+    bool gpu = false;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    ProfileScope(ProfilePhase p) : phase(p) {
+        if (profiler.gpuTimers && profiler.activeGpuPhase < 0) {
+            glBeginQuery(GL_TIME_ELAPSED, profiler.queries[profiler.set][phase]);
+            profiler.activeGpuPhase = phase;
+            profiler.issued[profiler.set][phase] = true;
+            gpu = true;
+        }
+    }
+    ~ProfileScope() {
+        if (gpu) {
+            glEndQuery(GL_TIME_ELAPSED);
+            profiler.activeGpuPhase = -1;
+        }
+        profiler.cpuFrame[phase] += std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+// Glyph cache - glyphs are rasterized on first use (any Unicode codepoint) into a fixed-size
+// atlas packed in horizontal shelves. When the atlas is full the least recently used shelf
+// is evicted. ASCII entries are also reachable through a direct pointer table.
+const int FONT_ATLAS_HEIGHT = 256;    // Atlas height in texels
+struct GlyphShelf {
+    int y = 0;
+    int height = 0;
+    int x = 0;                        // Next free column
+    unsigned int lastUsed = 0;        // Most recent text frame any glyph on it was drawn
+};
+std::unordered_map<uint64_t, Character> glyphCache;   // Keyed by glyphKey(codepoint)
+Character* asciiGlyphs[128] = {};
+std::vector<GlyphShelf> glyphShelves;
+int glyphShelfBottom = 0;             // First atlas row not used by a shelf
+unsigned int textFrame = 1;           // Advanced by endTextFrame
+FT_Library fontLibrary = nullptr;     // Kept open for lazy rasterization
+FT_Face fontFace = nullptr;
+inline uint64_t glyphKey(uint32_t codepoint) {
+    return ((uint64_t)FONT_PIXEL_SIZE << 32) | codepoint;
+}
+
+// Font atlas cache - the baked atlas image, shelves and glyph metrics are stored next to the
+// font (<font>.sdfcache) so later launches skip FreeType and SDF generation. The header
+// records everything the bake depends on; any mismatch rebuilds the file.
+const char* FONT_CACHE_SUFFIX = ".sdfcache";
+const uint32_t FONT_CACHE_MAGIC = 0x46445350;  // "PSDF"
+const uint32_t FONT_CACHE_VERSION = 1;
+struct FontCacheHeader {
+    uint32_t magic = FONT_CACHE_MAGIC;
+    uint32_t version = FONT_CACHE_VERSION;
+    uint64_t fontHash = 0;            // FNV-1a of the font file
+    int32_t pixelSize = FONT_PIXEL_SIZE;
+    int32_t sdfDownsample = FONT_SDF_DOWNSAMPLE;
+    int32_t sdfSpread = FONT_SDF_SPREAD;
+    int32_t atlasWidth = FONT_ATLAS_WIDTH;
+    int32_t atlasHeight = FONT_ATLAS_HEIGHT;
+    int32_t glyphCount = 0;
+    int32_t shelfCount = 0;
+    int32_t shelfBottom = 0;
+};
+struct FontCacheShelf {
+    int32_t y, height, x;
+};
+struct FontCacheGlyph {
+    uint32_t codepoint;
+    int32_t sizeX, sizeY, bearingX, bearingY, cellX, cellY, shelf;
+    uint32_t advance;
+    float uvMinX, uvMinY, uvMaxX, uvMaxY;
+};
+std::string fontPath;                 // Font the glyph cache was built from
+uint64_t fontFileHash = 0;
+
+// Startup timing - main records the launch time and the first presented frame prints the total
+std::chrono::high_resolution_clock::time_point appStartTime;
+bool firstFramePresented = false;
+
+// Headless mode (--headless) - no GLUT window: a surfaceless context renders into an
+// offscreen framebuffer that stands in for the window (screenFramebuffer is 0 otherwise)
+bool headlessMode = false;
+GLuint screenFramebuffer = 0;
+#ifdef POK3DEX_HEADLESS_EGL
+EGLDisplay headlessDisplay = EGL_NO_DISPLAY;
+EGLContext headlessContext = EGL_NO_CONTEXT;
+#endif
+
+// Retained text - a label keeps its laid-out quads (at the origin) and its pixel width,
+// and is only laid out again when its string, scale or the font changes.
+struct TextLabel {
+    std::string text;
+    float scale = 0.0f;
+    unsigned int fontGeneration = 0;
+    std::vector<TextVertex> quads;
+    std::vector<int> shelves;         // Atlas shelves the quads sample, kept warm while drawn
+    float width = 0.0f;
+};
+unsigned int fontGeneration = 0;   // Bumped by loadFont so every label re-lays itself out
+
+// Text CPU cost - pass --text-stats to print the average per-frame time spent on text
+bool showTextStats = false;
+double textCpuMs = 0.0;
+int textStatsFrames = 0;
+struct TextTimer {
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    ~TextTimer() {
+        textCpuMs += std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+// Camera uniform block (std140, binding point 0) shared by every 3D program.
+// The camera is fixed, so the block is only re-uploaded when setCamera changes it.
+const GLuint CAMERA_BLOCK_BINDING = 0;
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+GLuint cameraUbo = 0;
+bool cameraDirty = true;
+CameraBlock cameraBlock;
+
+// Camera placement - frames the 0.5-unit model container used by loadModel
+const float CAMERA_FOV_Y = 45.0f;        // Field of view angle (degrees)
+const float CAMERA_CONTAINER_H = 0.5f;   // Height of the model container (world units)
+const float CAMERA_Y = -0.05f;           // Camera and target height (world units)
+
+// Gallery (G on the start screen, or --gallery) - an attract-mode grid of spinning models.
+// The geometry of every model in the grid is copied into shared position/texcoord/index
+// pools and their diffuse textures into one texture array, so the grid is drawn with a
+// single glMultiDrawElementsIndirect call (one command per mesh) however large it grows.
+// Each frame a compute pass culls the models' bounding spheres against the frustum, picks
+// a LOD from their projected size and compacts the survivors into the indirect buffer.
+const int GALLERY_COLUMNS = 8;
+const int GALLERY_ROWS = 5;
+const float GALLERY_SPACING = 0.6f;      // World units between cell centres
+const int GALLERY_TEXTURE_SIZE = 256;    // Texture array layer size (diffuse maps are resampled)
+const int GALLERY_LODS = 3;              // LOD 0 is the original mesh
+const int GALLERY_LOD_CELLS[GALLERY_LODS] = { 0, 48, 20 };      // Vertex clustering grid per model height
+const glm::vec2 GALLERY_LOD_PIXELS(220.0f, 90.0f);              // Projected diameters for LOD 1 / LOD 2
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+struct GalleryInstance {
+    glm::mat4 model;                     // Cell placement; the shared spin is applied in the shader
+    float layer;                         // Texture array layer (-1 = untextured)
+    float padding[3];
+};
+struct GalleryDraw {                     // std430 layout shared with shaders/gallery_cull.glsl
+    glm::vec4 sphere;                    // World-space bounding sphere of the mesh's model
+    GLuint lodCount[4];
+    GLuint lodFirst[4];
+    GLint baseVertex;
+    GLuint baseInstance;
+    GLuint padding[2];
+};
+struct Gallery {
+    GLuint vao = 0;
+    GLuint positions = 0, texCoords = 0, indices = 0;   // Shared pools
+    GLuint instances = 0, commands = 0;
+    GLuint draws = 0, drawCount = 0;                     // Cull input and survivor counter
+    GLuint textureArray = 0;
+    std::vector<int> ids;
+    std::vector<GalleryDraw> drawList;
+    std::vector<GalleryInstance> instanceList;           // One per draw (baseInstance)
+    std::vector<DrawElementsIndirectCommand> visible;    // CPU culling output
+    CameraBlock gameCamera;                              // Restored when leaving the gallery
+    std::chrono::steady_clock::time_point enterTime;
+    bool built = false;
+};
+Gallery gallery;
+ShaderProgram galleryProgram, galleryCullProgram;
+bool useMultiDrawIndirect = false;       // GL 4.3 / ARB_multi_draw_indirect, else one draw per mesh
+bool useGpuCulling = false;              // GL 4.3 compute + SSBOs, else culled on the CPU
+bool useIndirectCount = false;           // ARB_indirect_parameters: the GPU supplies the draw count
+bool startInGallery = false;             // --gallery
+
+// ===============================
+// Function: hashBytes
+// Purpose: Folds a byte range into a 64-bit FNV-1a hash.
+// Parameters: hash - running hash, so several ranges can be chained into one key.
+// ===============================
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 1469598103934665603ULL) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
 // ===============================
 // Function: loadShaderSource
@@ -315,26 +871,49 @@ GLuint compileShader(GLenum type, const char* source) {
 }
 
 // ===============================
-// Function: createShaderProgram
-// Purpose: Creates a complete shader program from vertex and fragment shaders.
-// Parameters: vertexPath, fragmentPath - paths to shader files.
-// Returns: Linked shader program ID.
+// Function: describeProgram
+// Purpose: Caches a linked program's uniform locations and routes its camera block.
+// Returns: The program wrapped as a ShaderProgram.
 // ===============================
 
-// Function: createShaderProgram
-// Purpose: Creates a complete shader program from vertex and fragment shaders
-// Parameters:
-//   - vertexPath: Path to vertex shader file
-//   - fragmentPath: Path to fragment shader file
-// Returns: Linked shader program ID
-GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath) {
-    std::string vertSource = loadShaderSource(vertexPath);
-    std::string fragSource = loadShaderSource(fragmentPath);
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertSource.c_str());
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragSource.c_str());
+ShaderProgram describeProgram(GLuint program) {
+    ShaderProgram result;
+    result.id = program;
+
+    // Cache every active uniform location so draws never call glGetUniformLocation
+    GLint uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for (GLint i = 0; i < uniformCount; i++) {
+        char name[128];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+        GLint location = glGetUniformLocation(program, name);
+        if (location >= 0) {
+            result.uniforms[name] = location;
+        }
+    }
+
+    // Route the camera block (if the program uses it) to the shared binding point
+    GLuint cameraIndex = glGetUniformBlockIndex(program, "Camera");
+    if (cameraIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, cameraIndex, CAMERA_BLOCK_BINDING);
+    }
+    return result;
+}
+
+// ===============================
+// Function: linkShaderProgram
+// Purpose: Links compiled shaders into a program and caches its uniform locations.
+// Parameters: shaders - compiled shader objects (deleted here once linked).
+// Returns: Linked shader program.
+// ===============================
+
+ShaderProgram linkShaderProgram(const std::vector<GLuint>& shaders) {
     GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
+    for (GLuint shader : shaders) glAttachShader(program, shader);
+    if (useProgramBinaryCache) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
     GLint success;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
@@ -343,280 +922,2386 @@ GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath) {
         glGetProgramInfoLog(program, 512, nullptr, infoLog);
         std::cerr << "Shader linking failed: " << infoLog << std::endl;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    return program;
+    for (GLuint shader : shaders) glDeleteShader(shader);
+    return describeProgram(program);
 }
 
 // ===============================
-// Function: setTextureParameters
-// Purpose: Sets up texture parameters for OpenGL textures.
-// Parameters: texture - OpenGL texture ID to configure.
+// Function: initProgramBinaryCache
+// Purpose: Enables the program binary cache if the driver can save binaries, and builds
+//          the driver part of the cache key from the GL vendor, renderer and version.
 // ===============================
 
-// Function: setTextureParameters
-// Purpose: Sets up texture parameters for OpenGL textures
-// Parameters:
-//   - texture: OpenGL texture ID to configure
-void setTextureParameters(GLuint texture) {
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+void initProgramBinaryCache() {
+    GLint formatCount = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+    if (formatCount <= 0) {
+        useProgramBinaryCache = false;
+        return;
+    }
+    programBinaryFormats.resize(formatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, (GLint*)programBinaryFormats.data());
+
+    uint64_t hash = hashBytes(nullptr, 0);
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* value = (const char*)glGetString(name);
+        if (value) hash = hashBytes(value, strlen(value) + 1, hash);  // Terminator separates the strings
+    }
+    programCacheDriverHash = hash;
 }
 
 // ===============================
-// Function: loadTexture
-// Purpose: Loads a texture from an image file.
-// Parameters: path - path to the texture image file.
-// Returns: OpenGL texture ID.
+// Function: programCachePath
+// Purpose: Names the cache file of a program after its stage files and defines, e.g.
+//          shaders/vertex.glsl + fragment.glsl with REVEAL -> shaders/vertex+fragment.REVEAL.progbin.
 // ===============================
 
-// Function: loadTexture
-// Purpose: Loads a texture from an image file
-// Parameters:
-//   - path: Path to the texture image file
-// Returns: OpenGL texture ID
-// Note: Can be modified to change texture loading behavior
-GLuint loadTexture(const char* path) {
-    stbi_set_flip_vertically_on_load(true);
-    int w, h, ch;
-    unsigned char* data = stbi_load(path, &w, &h, &ch, 4);
-
-    if (!data) {
-        std::cerr << "ERROR: Failed to load texture at " << path
-            << "\nReason: " << stbi_failure_reason() << std::endl;
-        return 0;
+std::string programCachePath(const std::vector<ShaderStage>& stages, const std::vector<std::string>& defines) {
+    std::string path;
+    for (const ShaderStage& stage : stages) {
+        std::string name = stage.path;
+        if (!path.empty()) {
+            name = name.substr(name.find_last_of('/') + 1);  // Directory only once
+            path += "+";
+        }
+        path += name.substr(0, name.rfind(".glsl"));
     }
+    for (const std::string& name : defines) path += "." + name;
+    return path + PROGRAM_CACHE_SUFFIX;
+}
 
-    if (w <= 0 || h <= 0) {
-        std::cerr << "Invalid texture dimensions for " << path << "!" << std::endl;
-        stbi_image_free(data);
+// ===============================
+// Function: loadProgramBinary
+// Purpose: Creates a program from its cached binary if the cache matches the sources and driver.
+// Returns: Linked program ID, or 0 if the cache is missing, stale or rejected by the driver.
+// ===============================
+
+GLuint loadProgramBinary(const std::string& cachePath, uint64_t sourceHash) {
+    std::ifstream in(cachePath, std::ios::binary | std::ios::ate);
+    if (!in) return 0;
+    std::vector<char> data((size_t)in.tellg());
+    in.seekg(0);
+    in.read(data.data(), data.size());
+    if (!in || data.size() < sizeof(ProgramCacheHeader)) return 0;
+
+    ProgramCacheHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    ProgramCacheHeader expected;
+    bool knownFormat = std::find(programBinaryFormats.begin(), programBinaryFormats.end(),
+        header.binaryFormat) != programBinaryFormats.end();
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.sourceHash != sourceHash || header.driverHash != programCacheDriverHash || !knownFormat ||
+        data.size() != sizeof(header) + header.binaryLength) {
+        std::cout << "Program cache " << cachePath << " is stale, recompiling" << std::endl;
         return 0;
     }
 
-    std::cout << "Loaded image: " << path << " (" << w << "x" << h << ", " << ch << " channels)" << std::endl;
-
-    GLuint tex;
-    glGenTextures(1, &tex);
-    if (tex == 0) {
-        std::cerr << "Failed to generate texture ID for " << path << std::endl;
-        stbi_image_free(data);
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, data.data() + sizeof(header), (GLsizei)header.binaryLength);
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // Drivers may refuse their own binaries (e.g. after an update that kept the version string)
+        std::cout << "Program cache " << cachePath << " was rejected by the driver, recompiling" << std::endl;
+        glDeleteProgram(program);
+        glGetError();
         return 0;
     }
-
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    setTextureParameters(tex);
-
-    stbi_image_free(data);
-    return tex;
+    return program;
 }
 
 // ===============================
-// Function: renderText
-// Purpose: Renders text using FreeType fonts.
-// Parameters: text, x, y, scale, color.
+// Function: saveProgramBinary
+// Purpose: Writes a freshly linked program's binary to its cache file.
 // ===============================
 
-// Function: renderText
-// Purpose: Renders text using FreeType fonts
-// Parameters:
-//   - text: Text to render
-//   - x, y: Screen coordinates
-//   - scale: Text size multiplier
-//   - color: RGB color values
-void renderText(const std::string& text, float x, float y, float scale, glm::vec3 color) {
-    glPushAttrib(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT);  // Save color state
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    // Get current color and alpha
-    GLfloat currentColor[4];
-    glGetFloatv(GL_CURRENT_COLOR, currentColor);
-
-    for (auto c = text.begin(); c != text.end(); c++) {
-        Character ch = characters[*c];
-        float xpos = x + ch.bearing.x * scale;
-        float ypos = y + (ch.size.y - ch.bearing.y) * scale;
-        glBindTexture(GL_TEXTURE_2D, ch.textureID);
-        glColor4f(color.r, color.g, color.b, currentColor[3]);  // Use current alpha
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 0); glVertex2f(xpos, ypos);
-        glTexCoord2f(1, 0); glVertex2f(xpos + ch.size.x * scale, ypos);
-        glTexCoord2f(1, 1); glVertex2f(xpos + ch.size.x * scale, ypos - ch.size.y * scale);
-        glTexCoord2f(0, 1); glVertex2f(xpos, ypos - ch.size.y * scale);
-        glEnd();
-        x += (ch.advance >> 6) * scale;
+void saveProgramBinary(GLuint program, const std::string& cachePath, uint64_t sourceHash) {
+    GLint success = GL_FALSE, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!success || length <= 0) return;
+
+    std::vector<char> binary(length);
+    ProgramCacheHeader header;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &header.binaryFormat, binary.data());
+    if (written <= 0) return;
+    header.sourceHash = sourceHash;
+    header.driverHash = programCacheDriverHash;
+    header.binaryLength = (uint32_t)written;
+
+    std::ofstream out(cachePath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Could not write program cache " << cachePath << std::endl;
+        return;
     }
+    out.write((const char*)&header, sizeof(header));
+    out.write(binary.data(), written);
+    std::cout << "Program binary cached to " << cachePath << std::endl;
+}
 
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-    glDisable(GL_BLEND);
-    glPopAttrib();  // Restore color state
+// ===============================
+// Function: applyShaderDefines
+// Purpose: Specializes GLSL source by inserting "#define NAME 1" lines after its #version line.
+// ===============================
+
+std::string applyShaderDefines(const std::string& source, const std::vector<std::string>& defines) {
+    if (defines.empty()) return source;
+    std::string block;
+    for (const std::string& name : defines) block += "#define " + name + " 1\n";
+    size_t lineEnd = source.find('\n');
+    if (lineEnd == std::string::npos) return source + "\n" + block;
+    return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
 }
 
 // ===============================
-// Function: loadFont
-// Purpose: Loads a font using FreeType and creates OpenGL textures for each glyph.
-// Parameters: path - path to the .ttf font file.
+// Function: buildProgram
+// Purpose: Creates a program from its stage files, from the binary cache when it is valid.
+// Parameters: stages - shader type and source file of every stage,
+//             defines - permutation features enabled in every stage (see applyShaderDefines).
+// Returns: Linked program with its uniform locations cached.
+// Notes: The cache key covers the stage types and specialized sources, so any edit to a shader file
+//        recompiles it; a driver change is caught by the driver hash and binary format.
 // ===============================
 
-void loadFont(const char* path) {
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) {
-        std::cerr << "ERROR::FREETYPE: Failed to initialize FreeType" << std::endl;
-        return;
+ShaderProgram buildProgram(const std::vector<ShaderStage>& stages, const std::vector<std::string>& defines) {
+    std::vector<std::string> sources;
+    uint64_t sourceHash = hashBytes(nullptr, 0);
+    for (const ShaderStage& stage : stages) {
+        sources.push_back(applyShaderDefines(loadShaderSource(stage.path), defines));
+        sourceHash = hashBytes(&stage.type, sizeof(stage.type), sourceHash);
+        sourceHash = hashBytes(sources.back().data(), sources.back().size(), sourceHash);
     }
 
-    FT_Face face;
-    if (FT_New_Face(ft, path, 0, &face)) {
-        std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
-        FT_Done_FreeType(ft);
-        return;
+    std::string cachePath = programCachePath(stages, defines);
+    if (useProgramBinaryCache) {
+        GLuint program = loadProgramBinary(cachePath, sourceHash);
+        if (program != 0) return describeProgram(program);
     }
 
-    // Set font size
-    FT_Set_Pixel_Sizes(face, 0, 64);
-
-    // Clear existing characters
-    characters.clear();
-
-    // Load all ASCII characters
-    for (unsigned char c = 0; c < 128; c++) {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            std::cerr << "ERROR::FREETYPE: Failed to load Glyph " << c << std::endl;
-            continue;
-        }
-
-        // Generate texture
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+    std::vector<GLuint> shaders;
+    for (size_t i = 0; i < stages.size(); i++) {
+        shaders.push_back(compileShader(stages[i].type, sources[i].c_str()));
+    }
+    ShaderProgram result = linkShaderProgram(shaders);
+    if (useProgramBinaryCache) saveProgramBinary(result.id, cachePath, sourceHash);
+    return result;
+}
 
-        // Convert bitmap to RGBA
-        GLubyte* rgbaData = new GLubyte[face->glyph->bitmap.width * face->glyph->bitmap.rows * 4];
-        for (int i = 0; i < face->glyph->bitmap.width * face->glyph->bitmap.rows; i++) {
-            rgbaData[i * 4] = 255;     // R
-            rgbaData[i * 4 + 1] = 255; // G
-            rgbaData[i * 4 + 2] = 255; // B
-            rgbaData[i * 4 + 3] = face->glyph->bitmap.buffer[i]; // A
-        }
+// ===============================
+// Function: createShaderProgram
+// Purpose: Creates a complete shader program from vertex and fragment shaders.
+// Parameters: vertexPath, fragmentPath - paths to shader files.
+// Returns: Linked shader program with its uniform locations cached.
+// ===============================
 
-        // Upload texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaData);
+// Function: createShaderProgram
+// Purpose: Creates a complete shader program from vertex and fragment shaders
+// Parameters:
+//   - vertexPath: Path to vertex shader file
+//   - fragmentPath: Path to fragment shader file
+// Returns: Linked shader program with cached uniform locations
+ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPath) {
+    return buildProgram({ { GL_VERTEX_SHADER, vertexPath }, { GL_FRAGMENT_SHADER, fragmentPath } }, {});
+}
 
-        delete[] rgbaData;
+// ===============================
+// Function: createComputeProgram
+// Purpose: Creates a compute program from a single shader file (GL 4.3).
+// Parameters: computePath - path to the compute shader file.
+// Returns: Linked program with its uniform locations cached.
+// ===============================
 
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+ShaderProgram createComputeProgram(const char* computePath) {
+    return buildProgram({ { GL_COMPUTE_SHADER, computePath } }, {});
+}
 
-        // Store character
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        characters[c] = character;
-    }
+// ===============================
+// Function: shaderVariant
+// Purpose: Returns the variant of a permutation set for a feature mask, compiling it
+//          (or loading it from the binary cache) the first time the mask is used.
+// Notes: Variants live in an unordered_map, so returned references stay valid.
+// ===============================
 
-    // Clean up
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+const ShaderProgram& shaderVariant(ShaderPermutations& set, uint32_t mask) {
+    auto it = set.variants.find(mask);
+    if (it != set.variants.end()) return it->second;
 
-    // Verify font loading
-    if (characters.empty() || characters.find('A') == characters.end()) {
-        std::cerr << "ERROR::FREETYPE: Font loading verification failed" << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::string> defines;
+    for (size_t bit = 0; bit < set.features.size(); bit++) {
+        if (mask & (1u << bit)) defines.push_back(set.features[bit]);
     }
-    else {
-        std::cout << "Font loaded successfully!" << std::endl;
+    ShaderProgram& variant = set.variants[mask];
+    variant = buildProgram({ { GL_VERTEX_SHADER, set.vertexPath }, { GL_FRAGMENT_SHADER, set.fragmentPath } },
+        defines);
+    if (set.onCreate) set.onCreate(variant);
+    if (set.warmed) {
+        // Past startup this is a hitch; add the mask to the warm-up list if it shows up
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "Built shader variant 0x" << std::hex << mask << std::dec << " of "
+            << set.fragmentPath << " on first use (" << ms << " ms)" << std::endl;
     }
+    return variant;
 }
 
 // ===============================
-// Function: initSound
-// Purpose: Loads all sound files and initializes OpenAL sources for BGM and SFX.
+// Function: warmShaderVariants
+// Purpose: Builds the variants a pass is known to need before the first frame.
 // ===============================
 
-void initSound() {
-    alDevice = alcOpenDevice(nullptr);
-    alContext = alcCreateContext(alDevice, nullptr);
-    alcMakeContextCurrent(alContext);
-
-    auto loadSound = [](const char* path) -> ALuint {
-        drwav wav;
-        if (!drwav_init_file(&wav, path, nullptr)) return 0;
-
-        std::vector<int16_t> pcmData(wav.totalPCMFrameCount * wav.channels);
-        drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, pcmData.data());
+void warmShaderVariants(ShaderPermutations& set, const std::vector<uint32_t>& masks) {
+    for (uint32_t mask : masks) shaderVariant(set, mask);
+    set.warmed = true;
+}
 
-        ALuint buffer;
-        alGenBuffers(1, &buffer);
-        alBufferData(buffer, wav.channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16,
-            pcmData.data(), pcmData.size() * sizeof(int16_t), wav.sampleRate);
+// ===============================
+// Function: setupModelVariant
+// Purpose: Sets the constant uniforms of a freshly built model shader variant.
+// ===============================
 
-        drwav_uninit(&wav);
-        return buffer;
-        };
+void setupModelVariant(const ShaderProgram& variant) {
+    glUseProgram(variant.id);
+    glUniform3fv(variant.uniform("silhouetteColor"), 1, &SILHOUETTE_COLOR[0]);
+    glUniform1i(variant.uniform("texture1"), 0);  // Sampler always reads texture unit 0
+    glUseProgram(0);
+}
 
-    ALuint bgmBuffer = loadSound("assets/sounds/bgm.wav");
-    ALuint successBuffer = loadSound("assets/sounds/success.wav");
-    ALuint failureBuffer = loadSound("assets/sounds/failure.wav");
-    ALuint gameBgmBuffer = loadSound("assets/sounds/guess_bgm.wav");
-    ALuint gameOverBuffer = loadSound("assets/sounds/game_over.wav");
-    ALuint winnerBgmBuffer = loadSound("assets/sounds/winner_bgm.wav");
+// ===============================
+// Function: modelShaderMask
+// Purpose: Picks the model shader features needed for a reveal amount.
+// ===============================
 
-    alGenSources(1, &bgmSource);
-    alSourcei(bgmSource, AL_BUFFER, bgmBuffer);
-    alSourcei(bgmSource, AL_LOOPING, AL_TRUE);
+uint32_t modelShaderMask(float reveal) {
+    if (reveal <= 0.0f) return 0;                      // Flat silhouette, no texture reads
+    if (reveal >= 1.0f) return MODEL_SHADER_TEXTURED;  // Nothing left to blend
+    return MODEL_SHADER_TEXTURED | MODEL_SHADER_REVEAL;
+}
 
-    alGenSources(1, &gameBgmSource);
-    alSourcei(gameBgmSource, AL_BUFFER, gameBgmBuffer);
-    alSourcei(gameBgmSource, AL_LOOPING, AL_TRUE);
+// ===============================
+// Function: initCameraBlock
+// Purpose: Creates the camera uniform buffer and binds it to CAMERA_BLOCK_BINDING.
+// ===============================
 
-    alGenSources(1, &successSource);
-    alSourcei(successSource, AL_BUFFER, successBuffer);
+void initCameraBlock() {
+    glGenBuffers(1, &cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, cameraUbo);
+    cameraDirty = true;
+}
 
-    alGenSources(1, &failureSource);
-    alSourcei(failureSource, AL_BUFFER, failureBuffer);
+// ===============================
+// Function: setCamera
+// Purpose: Sets the view/projection matrices and marks the camera block for upload.
+// Parameters: eye, target - camera position and look-at point; aspect - viewport aspect ratio.
+// ===============================
 
-    alGenSources(1, &gameOverSource);
-    alSourcei(gameOverSource, AL_BUFFER, gameOverBuffer);
+void setCamera(glm::vec3 eye, glm::vec3 target, float aspect) {
+    cameraBlock.view = glm::lookAt(eye, target, glm::vec3(0, 1, 0));
+    cameraBlock.projection = glm::perspective(glm::radians(CAMERA_FOV_Y), aspect, 0.1f, 100.0f);
+    cameraDirty = true;
+}
 
-    alGenSources(1, &winnerBgmSource);
-    alSourcei(winnerBgmSource, AL_BUFFER, winnerBgmBuffer);
-    alSourcei(winnerBgmSource, AL_LOOPING, AL_TRUE);
+// ===============================
+// Function: updateCameraBlock
+// Purpose: Uploads the camera block if it changed since the last upload.
+// ===============================
 
-    alSourcePlay(bgmSource);
+void updateCameraBlock() {
+    if (!cameraDirty) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &cameraBlock);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    cameraDirty = false;
 }
 
 // ===============================
-// Function: loadModel
-// Purpose: Loads a 3D model for a Pokémon using Assimp.
-// Parameters: id - Pokémon ID (1-151).
-// Notes: Controls model scaling, camera, and material/texture setup.
+// Function: createStaticBuffer
+// Purpose: Creates a buffer holding data that never changes after creation.
+// Parameters: size - bytes, data - initial contents (may be null).
+// Returns: Buffer ID (immutable storage on the DSA path).
+// Notes: The fallback uploads through GL_COPY_WRITE_BUFFER so no VAO or draw binding is
+//        disturbed; the buffer can be bound to any target afterwards.
 // ===============================
 
-// Function: loadModel
+GLuint createStaticBuffer(GLsizeiptr size, const void* data) {
+    GLuint buffer = 0;
+    if (useDirectStateAccess) {
+        glCreateBuffers(1, &buffer);
+        // Immutable storage cannot be empty; meshes without texcoords or normals get one byte
+        glNamedBufferStorage(buffer, std::max<GLsizeiptr>(size, 1), size > 0 ? data : nullptr, 0);
+        return buffer;
+    }
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return buffer;
+}
+
+// ===============================
+// Function: createVertexArray
+// Purpose: Creates an empty VAO (already initialized on the DSA path, so it can be edited unbound).
+// ===============================
+
+GLuint createVertexArray() {
+    GLuint vao = 0;
+    if (useDirectStateAccess) glCreateVertexArrays(1, &vao);
+    else glGenVertexArrays(1, &vao);
+    return vao;
+}
+
+// ===============================
+// Function: attachVertexBuffer
+// Purpose: Feeds a tightly packed float attribute of a VAO from a buffer.
+// Parameters: location - attribute location (also used as its binding point on the DSA path),
+//             components - floats per vertex.
+// ===============================
+
+void attachVertexBuffer(GLuint vao, GLuint location, GLuint buffer, GLint components) {
+    if (useDirectStateAccess) {
+        glVertexArrayVertexBuffer(vao, location, buffer, 0, components * (GLsizei)sizeof(float));
+        glVertexArrayAttribFormat(vao, location, components, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(vao, location, location);
+        glEnableVertexArrayAttrib(vao, location);
+        return;
+    }
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(location);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// ===============================
+// Function: attachIndexBuffer
+// Purpose: Sets the element buffer of a VAO.
+// ===============================
+
+void attachIndexBuffer(GLuint vao, GLuint buffer) {
+    if (useDirectStateAccess) {
+        glVertexArrayElementBuffer(vao, buffer);
+        return;
+    }
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    glBindVertexArray(0);
+}
+
+// ===============================
+// Function: createTexture2D
+// Purpose: Allocates a 2D texture without contents.
+// Parameters: internalFormat - GL_RGBA8 or GL_R8, levels - mip levels to allocate.
+// Returns: Texture ID (immutable storage on the DSA path).
+// Notes: The fallback only allocates level 0; glGenerateMipmap adds the rest.
+// ===============================
+
+GLuint createTexture2D(GLenum internalFormat, int w, int h, int levels) {
+    GLuint tex = 0;
+    if (useDirectStateAccess) {
+        glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+        glTextureStorage2D(tex, levels, internalFormat, w, h);
+        return tex;
+    }
+    GLenum format = internalFormat == GL_R8 ? GL_RED : GL_RGBA;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    return tex;
+}
+
+// ===============================
+// Function: uploadTexture2D
+// Purpose: Fills a texture's level 0 from client memory, or from the bound pixel-unpack buffer
+//          when pixels is an offset.
+// ===============================
+
+void uploadTexture2D(GLuint tex, int x, int y, int w, int h, GLenum format, const void* pixels) {
+    if (useDirectStateAccess) {
+        glTextureSubImage2D(tex, 0, x, y, w, h, format, GL_UNSIGNED_BYTE, pixels);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, GL_UNSIGNED_BYTE, pixels);
+}
+
+// ===============================
+// Function: setTextureSampling
+// Purpose: Sets the wrap mode and (min and mag) filter of a 2D texture without mipmaps.
+// ===============================
+
+void setTextureSampling(GLuint tex, GLenum wrap, GLenum filter) {
+    if (useDirectStateAccess) {
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_S, wrap);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_T, wrap);
+        glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, filter);
+        glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, filter);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+}
+
+// ===============================
+// Function: mipLevelCount
+// Purpose: Returns the number of mip levels of a full chain for a w x h texture.
+// ===============================
+
+int mipLevelCount(int w, int h) {
+    int levels = 1;
+    for (int size = std::max(w, h); size > 1; size /= 2) levels++;
+    return levels;
+}
+
+// ===============================
+// Function: setTextureParameters
+// Purpose: Sets up texture parameters for OpenGL textures.
+// Parameters: texture - OpenGL texture ID to configure.
+// ===============================
+
+// Function: setTextureParameters
+// Purpose: Sets up texture parameters for OpenGL textures
+// Parameters:
+//   - texture: OpenGL texture ID to configure
+void setTextureParameters(GLuint texture) {
+    if (useDirectStateAccess) {
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenerateTextureMipmap(texture);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+// ===============================
+// Function: initPboRing
+// Purpose: Creates and persistently maps the pixel-unpack ring used for texture uploads.
+// Notes: Falls back to direct uploads when GL_ARB_buffer_storage is missing.
+// ===============================
+
+void initPboRing() {
+    if (!usePboRing) {
+        std::cout << "PBO ring disabled, using direct texture uploads" << std::endl;
+        return;
+    }
+    if (!GLEW_ARB_buffer_storage || !GLEW_ARB_sync) {
+        std::cout << "GL_ARB_buffer_storage not supported, using direct texture uploads" << std::endl;
+        usePboRing = false;
+        return;
+    }
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr ringBytes = PBO_RING_SLOTS * PBO_RING_SLOT_BYTES;
+    glGenBuffers(1, &pboRing.buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboRing.buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ringBytes, nullptr, flags);
+    pboRing.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringBytes, flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!pboRing.mapped) {
+        std::cerr << "Failed to map PBO ring, using direct texture uploads" << std::endl;
+        glDeleteBuffers(1, &pboRing.buffer);
+        pboRing.buffer = 0;
+        usePboRing = false;
+        return;
+    }
+    std::cout << "PBO ring ready: " << PBO_RING_SLOTS << " slots of "
+        << PBO_RING_SLOT_BYTES / (1024 * 1024) << " MB" << std::endl;
+}
+
+// ===============================
+// Function: destroyPboRing
+// Purpose: Unmaps and deletes the pixel-unpack ring and any pending fences.
+// ===============================
+
+void destroyPboRing() {
+    for (GLsync& fence : pboRing.fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+    if (pboRing.buffer) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboRing.buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &pboRing.buffer);
+        pboRing.buffer = 0;
+        pboRing.mapped = nullptr;
+    }
+}
+
+// ===============================
+// Function: tryAcquirePboSlot
+// Purpose: Reserves a ring slot that no worker holds and the GPU has finished reading.
+// Returns: Slot index (0 to PBO_RING_SLOTS - 1), or -1 if none is free right now.
+// Notes: Render thread only (fences are polled, never waited on). The slot stays reserved
+//        until uploadTextureFromPboSlot or releasePboSlot.
+// ===============================
+
+int tryAcquirePboSlot() {
+    if (!usePboRing) return -1;
+    for (int n = 0; n < PBO_RING_SLOTS; n++) {
+        int slot = (pboRing.next + n) % PBO_RING_SLOTS;
+        if (pboRing.reserved[slot]) continue;
+        if (pboRing.fences[slot]) {
+            GLenum result = glClientWaitSync(pboRing.fences[slot], 0, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) continue;
+            glDeleteSync(pboRing.fences[slot]);
+            pboRing.fences[slot] = 0;
+        }
+        pboRing.reserved[slot] = true;
+        pboRing.next = (slot + 1) % PBO_RING_SLOTS;
+        return slot;
+    }
+    return -1;
+}
+
+// ===============================
+// Function: releasePboSlot
+// Purpose: Returns a reserved slot whose contents will not be uploaded.
+// ===============================
+
+void releasePboSlot(int slot) {
+    if (slot >= 0) pboRing.reserved[slot] = false;
+}
+
+// ===============================
+// Function: writeImageToPboSlot
+// Purpose: Copies decoded RGBA pixels into a ring slot, flipping rows to OpenGL's bottom-up order.
+// Notes: Safe to call from decode threads for a slot reserved for them; touches only mapped memory.
+// ===============================
+
+void writeImageToPboSlot(int slot, const unsigned char* pixels, int w, int h) {
+    unsigned char* dst = pboRing.mapped + slot * PBO_RING_SLOT_BYTES;
+    size_t rowBytes = (size_t)w * 4;
+    for (int y = 0; y < h; y++) {
+        memcpy(dst + (size_t)(h - 1 - y) * rowBytes, pixels + (size_t)y * rowBytes, rowBytes);
+    }
+}
+
+// ===============================
+// Function: flipImageRows
+// Purpose: Flips RGBA pixels vertically in place (for uploads that bypass the ring).
+// ===============================
+
+void flipImageRows(unsigned char* pixels, int w, int h) {
+    size_t rowBytes = (size_t)w * 4;
+    std::vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < h / 2; y++) {
+        unsigned char* top = pixels + (size_t)y * rowBytes;
+        unsigned char* bottom = pixels + (size_t)(h - 1 - y) * rowBytes;
+        memcpy(row.data(), top, rowBytes);
+        memcpy(top, bottom, rowBytes);
+        memcpy(bottom, row.data(), rowBytes);
+    }
+}
+
+// ===============================
+// Function: uploadTextureFromPboSlot
+// Purpose: Creates a texture and fills it from a ring slot, then fences the slot.
+// Returns: OpenGL texture ID.
+// ===============================
+
+GLuint uploadTextureFromPboSlot(int slot, int w, int h) {
+    GLuint tex = createTexture2D(GL_RGBA8, w, h, mipLevelCount(w, h));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboRing.buffer);
+    uploadTexture2D(tex, 0, 0, w, h, GL_RGBA, (const void*)(slot * PBO_RING_SLOT_BYTES));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pboRing.fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pboRing.reserved[slot] = false;
+    setTextureParameters(tex);
+    return tex;
+}
+
+// ===============================
+// Function: uploadTextureFromMemory
+// Purpose: Creates a texture from bottom-up RGBA pixels in client memory.
+// Returns: OpenGL texture ID.
+// ===============================
+
+GLuint uploadTextureFromMemory(const unsigned char* pixels, int w, int h) {
+    GLuint tex = createTexture2D(GL_RGBA8, w, h, mipLevelCount(w, h));
+    uploadTexture2D(tex, 0, 0, w, h, GL_RGBA, pixels);
+    setTextureParameters(tex);
+    return tex;
+}
+
+// ===============================
+// Function: uploadDecodedTexture
+// Purpose: Uploads a worker-decoded texture, from its ring slot when it has one.
+// Returns: OpenGL texture ID (the pixels, if any, are freed here).
+// Notes: The worker already flipped the rows, so nothing here touches pixels on the CPU.
+// ===============================
+
+GLuint uploadDecodedTexture(const DecodedTexture& image) {
+    auto start = std::chrono::high_resolution_clock::now();
+    GLuint tex = 0;
+    if (image.slot >= 0) {
+        tex = uploadTextureFromPboSlot(image.slot, image.w, image.h);
+    }
+    else if (image.pixels) {
+        tex = uploadTextureFromMemory(image.pixels, image.w, image.h);
+        stbi_image_free(image.pixels);
+    }
+    textureUploadStallMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    return tex;
+}
+
+// ===============================
+// Function: uploadTexturePixels
+// Purpose: Uploads top-down RGBA pixels, through the ring when a slot is free and large enough.
+// Parameters: pixels - stbi-allocated pixels (freed here), w/h - image size.
+// Returns: OpenGL texture ID.
+// Notes: Used for the startup textures; streamed model textures go through uploadDecodedTexture.
+// ===============================
+
+GLuint uploadTexturePixels(unsigned char* pixels, int w, int h) {
+    GLuint tex = 0;
+    int slot = (size_t)w * h * 4 <= PBO_RING_SLOT_BYTES ? tryAcquirePboSlot() : -1;
+    if (slot >= 0) {
+        writeImageToPboSlot(slot, pixels, w, h);
+        tex = uploadTextureFromPboSlot(slot, w, h);
+    }
+    else {
+        flipImageRows(pixels, w, h);
+        tex = uploadTextureFromMemory(pixels, w, h);
+    }
+    stbi_image_free(pixels);
+    return tex;
+}
+
+// ===============================
+// Function: loadTexture
+// Purpose: Loads a texture from an image file.
+// Parameters: path - path to the texture image file.
+// Returns: OpenGL texture ID.
+// ===============================
+
+// Function: loadTexture
+// Purpose: Loads a texture from an image file
+// Parameters:
+//   - path: Path to the texture image file
+// Returns: OpenGL texture ID
+// Note: Can be modified to change texture loading behavior
+GLuint loadTexture(const char* path) {
+    // Rows are flipped while uploading (see uploadTexturePixels)
+    stbi_set_flip_vertically_on_load(false);
+    int w, h, ch;
+    unsigned char* data = stbi_load(path, &w, &h, &ch, 4);
+
+    if (!data) {
+        std::cerr << "ERROR: Failed to load texture at " << path
+            << "\nReason: " << stbi_failure_reason() << std::endl;
+        return 0;
+    }
+
+    if (w <= 0 || h <= 0) {
+        std::cerr << "Invalid texture dimensions for " << path << "!" << std::endl;
+        stbi_image_free(data);
+        return 0;
+    }
+
+    std::cout << "Loaded image: " << path << " (" << w << "x" << h << ", " << ch << " channels)" << std::endl;
+
+    GLuint tex = uploadTexturePixels(data, w, h);
+    if (tex == 0) {
+        std::cerr << "Failed to generate texture ID for " << path << std::endl;
+    }
+    return tex;
+}
+
+// ===============================
+// Function: renderKey
+// Purpose: Builds a render queue sort key: layer, sub-layer, program, texture, VAO
+//          (most to least significant), so equal state ends up adjacent.
+// ===============================
+
+uint64_t renderKey(RenderLayer layer, int subLayer, GLuint program, GLuint texture, GLuint vao) {
+    return ((uint64_t)(layer & 0xF) << 60) | ((uint64_t)(subLayer & 0xF) << 56) |
+        ((uint64_t)(program & 0xFFFF) << 40) | ((uint64_t)(texture & 0xFFFFF) << 20) | (vao & 0xFFFFF);
+}
+
+// ===============================
+// Function: renderQueueUses
+// Purpose: Reports whether a queued packet still reads from a VAO (and so its buffers).
+// ===============================
+
+bool renderQueueUses(GLuint vao) {
+    for (const RenderPacket& packet : renderQueue) {
+        if (packet.vao == vao) return true;
+    }
+    return false;
+}
+
+// ===============================
+// Function: countStateChanges
+// Purpose: Counts the program/texture/VAO/depth/blend changes needed to draw packets in order.
+// ===============================
+
+int countStateChanges(const std::vector<RenderPacket>& packets) {
+    GLuint program = ~0u, texture = ~0u, vao = ~0u;
+    int depthTest = -1, blend = -1, changes = 0;
+    for (const RenderPacket& packet : packets) {
+        if (packet.program != program) { program = packet.program; changes++; }
+        if (packet.texture != 0 && packet.texture != texture) { texture = packet.texture; changes++; }
+        if (packet.vao != vao) { vao = packet.vao; changes++; }
+        if ((int)packet.depthTest != depthTest) { depthTest = packet.depthTest; changes++; }
+        if ((int)packet.blend != blend) { blend = packet.blend; changes++; }
+    }
+    return changes;
+}
+
+// ===============================
+// Function: submitRenderQueue
+// Purpose: Sorts the queued packets by key and draws them, skipping state that is already set.
+// Notes: GL state set outside the queue is unknown, so nothing is assumed at the start of a
+//        submit. Leaves no VAO bound and depth test and blending disabled.
+// ===============================
+
+void submitRenderQueue() {
+    if (renderQueue.empty()) return;
+    renderQueueStats.packets += (int)renderQueue.size();
+    renderQueueStats.naive += 5 * (int)renderQueue.size();
+    renderQueueStats.inOrder += countStateChanges(renderQueue);
+
+    std::stable_sort(renderQueue.begin(), renderQueue.end(), [](const RenderPacket& a, const RenderPacket& b) {
+        return a.key < b.key;
+    });
+
+    glActiveTexture(GL_TEXTURE0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLuint program = ~0u, texture = ~0u, vao = ~0u;
+    int depthTest = -1, blend = -1;
+    const RenderPacket* lastModel = nullptr;
+    GLint modelLoc = -1, revealLoc = -1;
+    for (const RenderPacket& packet : renderQueue) {
+        if (packet.program != program) {
+            glUseProgram(packet.program);
+            program = packet.program;
+            lastModel = nullptr;
+            renderQueueStats.issued++;
+        }
+        if (packet.texture != 0 && packet.texture != texture) {
+            glBindTexture(GL_TEXTURE_2D, packet.texture);
+            texture = packet.texture;
+            renderQueueStats.issued++;
+        }
+        if (packet.vao != vao) {
+            glBindVertexArray(packet.vao);
+            vao = packet.vao;
+            renderQueueStats.issued++;
+        }
+        if ((int)packet.depthTest != depthTest) {
+            if (packet.depthTest) glEnable(GL_DEPTH_TEST);
+            else glDisable(GL_DEPTH_TEST);
+            depthTest = packet.depthTest;
+            renderQueueStats.issued++;
+        }
+        if ((int)packet.blend != blend) {
+            if (packet.blend) glEnable(GL_BLEND);
+            else glDisable(GL_BLEND);
+            blend = packet.blend;
+            renderQueueStats.issued++;
+        }
+        if (packet.hasModel) {
+            if (!lastModel) {
+                modelLoc = packet.shader->uniform("model");
+                revealLoc = packet.shader->uniform("reveal");
+            }
+            if (!lastModel || memcmp(&lastModel->model, &packet.model, sizeof(glm::mat4)) != 0) {
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &packet.model[0][0]);
+            }
+            if (revealLoc >= 0 && (!lastModel || lastModel->reveal != packet.reveal)) {
+                glUniform1f(revealLoc, packet.reveal);
+            }
+            lastModel = &packet;
+        }
+        if (packet.indexed) {
+            glDrawElements(GL_TRIANGLES, packet.count, GL_UNSIGNED_INT, (const void*)(intptr_t)packet.first);
+        }
+        else {
+            glDrawArrays(GL_TRIANGLES, packet.first, packet.count);
+        }
+        frameDrawCalls++;
+    }
+    glBindVertexArray(0);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    renderQueue.clear();
+}
+
+// ===============================
+// Function: createScreenQuadArray
+// Purpose: Creates a VAO/VBO pair with the TextVertex layout shared by all 2D passes.
+// ===============================
+
+void createScreenQuadArray(GLuint& vao, GLuint& vbo) {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, pos));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, uv));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, color));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// ===============================
+// Function: initSpriteBatcher
+// Purpose: Creates the sprite shader, the streaming vertex buffer and the white texture
+//          used for untextured quads.
+// ===============================
+
+void initSpriteBatcher() {
+    spriteProgram = createShaderProgram("shaders/sprite_vertex.glsl", "shaders/sprite_fragment.glsl");
+    glm::mat4 projection = glm::ortho(0.0f, (float)WIDTH, 0.0f, (float)HEIGHT);
+    glUseProgram(spriteProgram.id);
+    glUniformMatrix4fv(spriteProgram.uniform("projection"), 1, GL_FALSE, &projection[0][0]);
+    glUniform1i(spriteProgram.uniform("spriteTexture"), 0);
+    glUseProgram(0);
+
+    createScreenQuadArray(spriteVao, spriteVbo);
+
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &whiteTexture);
+    glBindTexture(GL_TEXTURE_2D, whiteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+// ===============================
+// Function: drawSprite
+// Purpose: Queues a textured (or, with texture 0, solid) screen-space quad for flushSprites.
+// Parameters: x/y/w/h - rectangle in pixels from the bottom-left corner,
+//             color - tint (alpha in w), layer - lower layers are drawn first.
+// ===============================
+
+void drawSprite(GLuint texture, float x, float y, float w, float h,
+    glm::vec4 color = glm::vec4(1.0f), int layer = 0) {
+    Sprite sprite;
+    sprite.texture = texture ? texture : whiteTexture;
+    sprite.layer = layer;
+    TextVertex* v = sprite.vertices;
+    v[0] = { glm::vec2(x, y + h), glm::vec2(0.0f, 1.0f), color };
+    v[1] = { glm::vec2(x, y), glm::vec2(0.0f, 0.0f), color };
+    v[2] = { glm::vec2(x + w, y), glm::vec2(1.0f, 0.0f), color };
+    v[3] = { glm::vec2(x, y + h), glm::vec2(0.0f, 1.0f), color };
+    v[4] = { glm::vec2(x + w, y), glm::vec2(1.0f, 0.0f), color };
+    v[5] = { glm::vec2(x + w, y + h), glm::vec2(1.0f, 1.0f), color };
+    queuedSprites.push_back(sprite);
+}
+
+// ===============================
+// Function: flushSprites
+// Purpose: Uploads every queued sprite, sorted by layer then texture, and queues one
+//          render packet per run.
+// Parameters: layer - render queue layer the sprites belong to (sprite layers become sub-layers).
+// Notes: The sort is stable, so sprites sharing a layer and texture keep their order.
+//        Sprites in one layer are expected not to overlap across textures.
+// ===============================
+
+void flushSprites(RenderLayer layer) {
+    if (queuedSprites.empty()) return;
+    if (renderQueueUses(spriteVao)) submitRenderQueue();  // The buffer is about to be refilled
+
+    std::stable_sort(queuedSprites.begin(), queuedSprites.end(), [](const Sprite& a, const Sprite& b) {
+        return a.layer != b.layer ? a.layer < b.layer : a.texture < b.texture;
+    });
+    spriteVertices.clear();
+    for (const Sprite& sprite : queuedSprites) {
+        spriteVertices.insert(spriteVertices.end(), sprite.vertices, sprite.vertices + 6);
+    }
+
+    // Orphan the buffer so the driver never waits on last frame's sprites
+    glBindBuffer(GL_ARRAY_BUFFER, spriteVbo);
+    size_t bytes = spriteVertices.size() * sizeof(TextVertex);
+    if (bytes > spriteVboCapacity) {
+        spriteVboCapacity = bytes * 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, spriteVboCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, spriteVertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    size_t runStart = 0;
+    for (size_t i = 1; i <= queuedSprites.size(); i++) {
+        const Sprite& first = queuedSprites[runStart];
+        if (i < queuedSprites.size() && queuedSprites[i].texture == first.texture &&
+            queuedSprites[i].layer == first.layer) continue;
+        RenderPacket packet;
+        packet.key = renderKey(layer, first.layer, spriteProgram.id, first.texture, spriteVao);
+        packet.program = spriteProgram.id;
+        packet.texture = first.texture;
+        packet.vao = spriteVao;
+        packet.blend = true;
+        packet.first = (GLint)(runStart * 6);
+        packet.count = (GLsizei)((i - runStart) * 6);
+        renderQueue.push_back(packet);
+        runStart = i;
+    }
+
+    queuedSprites.clear();
+}
+
+// ===============================
+// Function: initTextRenderer
+// Purpose: Creates the text shader and the streaming vertex buffer used by flushText.
+// ===============================
+
+void initTextRenderer() {
+    textProgram = createShaderProgram("shaders/text_vertex.glsl", "shaders/text_fragment.glsl");
+    glm::mat4 projection = glm::ortho(0.0f, (float)WIDTH, 0.0f, (float)HEIGHT);
+    glUseProgram(textProgram.id);
+    glUniformMatrix4fv(textProgram.uniform("projection"), 1, GL_FALSE, &projection[0][0]);
+    glUniform1i(textProgram.uniform("glyphAtlas"), 0);
+    glUseProgram(0);
+
+    createScreenQuadArray(textVao, textVbo);
+}
+
+// ===============================
+// Function: buildGlyphSdf
+// Purpose: Converts a FreeType coverage bitmap into a downsampled signed distance field.
+// Parameters: bitmap/w/h/pitch - glyph coverage, cellSize - receives the padded cell size
+//             in FONT_PIXEL_SIZE pixels (a multiple of FONT_SDF_DOWNSAMPLE).
+// Returns: SDF texels (cellSize / FONT_SDF_DOWNSAMPLE), 128 = glyph edge, 255 = deep inside.
+// ===============================
+
+std::vector<unsigned char> buildGlyphSdf(const unsigned char* bitmap, int w, int h, int pitch,
+    glm::ivec2& cellSize) {
+    const int pad = FONT_SDF_SPREAD * FONT_SDF_DOWNSAMPLE;  // Spread in source pixels
+    const int ds = FONT_SDF_DOWNSAMPLE;
+    cellSize.x = ((w + 2 * pad + ds - 1) / ds) * ds;
+    cellSize.y = ((h + 2 * pad + ds - 1) / ds) * ds;
+    int outW = cellSize.x / ds;
+    int outH = cellSize.y / ds;
+
+    auto inside = [&](int sx, int sy) {
+        int bx = sx - pad, by = sy - pad;
+        if (bx < 0 || by < 0 || bx >= w || by >= h) return false;
+        return bitmap[by * pitch + bx] >= 128;
+    };
+
+    std::vector<unsigned char> sdf((size_t)outW * outH);
+    for (int oy = 0; oy < outH; oy++) {
+        for (int ox = 0; ox < outW; ox++) {
+            // Sample at the centre of the source block covered by this texel
+            int sx = ox * ds + ds / 2;
+            int sy = oy * ds + ds / 2;
+            bool in = inside(sx, sy);
+            int best = pad * pad;
+            for (int dy = -pad; dy <= pad; dy++) {
+                for (int dx = -pad; dx <= pad; dx++) {
+                    int d2 = dx * dx + dy * dy;
+                    if (d2 < best && inside(sx + dx, sy + dy) != in) best = d2;
+                }
+            }
+            float dist = std::sqrt((float)best) / pad;  // 0..1 of the spread
+            float value = 0.5f + (in ? 0.5f : -0.5f) * dist;
+            sdf[(size_t)oy * outW + ox] = (unsigned char)(std::min(1.0f, std::max(0.0f, value)) * 255.0f);
+        }
+    }
+    return sdf;
+}
+
+// ===============================
+// Function: decodeUtf8
+// Purpose: Decodes the UTF-8 sequence starting at text[i] and advances i past it.
+// Returns: Unicode codepoint, or U+FFFD for malformed input.
+// ===============================
+
+uint32_t decodeUtf8(const std::string& text, size_t& i) {
+    unsigned char lead = (unsigned char)text[i++];
+    if (lead < 0x80) return lead;
+
+    int extra = 0;
+    uint32_t cp = 0;
+    if ((lead & 0xE0) == 0xC0) { extra = 1; cp = lead & 0x1F; }
+    else if ((lead & 0xF0) == 0xE0) { extra = 2; cp = lead & 0x0F; }
+    else if ((lead & 0xF8) == 0xF0) { extra = 3; cp = lead & 0x07; }
+    else return 0xFFFD;
+
+    for (int k = 0; k < extra; k++) {
+        if (i >= text.size() || ((unsigned char)text[i] & 0xC0) != 0x80) return 0xFFFD;
+        cp = (cp << 6) | ((unsigned char)text[i++] & 0x3F);
+    }
+    return cp;
+}
+
+// ===============================
+// Function: allocateGlyphRect
+// Purpose: Finds room for a glyph cell in the atlas using shelf packing.
+// Parameters: texels - cell size in atlas texels; pos/shelfIndex - receive the placement.
+// Returns: false when no shelf has room and no new shelf fits.
+// ===============================
+
+bool allocateGlyphRect(glm::ivec2 texels, glm::ivec2& pos, int& shelfIndex) {
+    const int padding = 1;
+    // Best fit: the shortest existing shelf that is tall enough and has space left
+    int best = -1;
+    for (size_t i = 0; i < glyphShelves.size(); i++) {
+        const GlyphShelf& shelf = glyphShelves[i];
+        if (texels.y <= shelf.height && shelf.x + texels.x + padding <= FONT_ATLAS_WIDTH) {
+            if (best < 0 || shelf.height < glyphShelves[best].height) best = (int)i;
+        }
+    }
+    if (best < 0 && glyphShelfBottom + texels.y + padding <= FONT_ATLAS_HEIGHT) {
+        GlyphShelf shelf;
+        shelf.y = glyphShelfBottom;
+        shelf.height = texels.y;
+        glyphShelves.push_back(shelf);
+        glyphShelfBottom += texels.y + padding;
+        best = (int)glyphShelves.size() - 1;
+    }
+    if (best < 0) return false;
+
+    GlyphShelf& shelf = glyphShelves[best];
+    pos = glm::ivec2(shelf.x, shelf.y);
+    shelf.x += texels.x + padding;
+    shelfIndex = best;
+    return true;
+}
+
+// ===============================
+// Function: evictColdestShelf
+// Purpose: Frees the least recently used atlas shelf tall enough for a new glyph.
+// Parameters: minHeight - height in texels the freed shelf must have.
+// Returns: false if no such shelf is free of glyphs used in the current frame.
+// Notes: Text already queued this frame is flushed first, since it may sample the shelf.
+//        Bumps fontGeneration so retained labels drop their cached UVs.
+// ===============================
+
+bool evictColdestShelf(int minHeight) {
+    int coldest = -1;
+    for (size_t i = 0; i < glyphShelves.size(); i++) {
+        if (glyphShelves[i].lastUsed == textFrame || glyphShelves[i].height < minHeight) continue;
+        if (coldest < 0 || glyphShelves[i].lastUsed < glyphShelves[coldest].lastUsed) coldest = (int)i;
+    }
+    if (coldest < 0) return false;
+
+    flushText();
+    submitRenderQueue();
+    for (auto it = glyphCache.begin(); it != glyphCache.end();) {
+        if (it->second.shelf == coldest) {
+            if (it->second.codepoint < 128) asciiGlyphs[it->second.codepoint] = nullptr;
+            it = glyphCache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    glyphShelves[coldest].x = 0;
+    fontGeneration++;
+    return true;
+}
+
+// ===============================
+// Function: resetGlyphAtlas
+// Purpose: Drops every glyph and shelf so the atlas can be packed again from the top.
+// Notes: Last resort when no shelf fits a new glyph; queued text is flushed first.
+// ===============================
+
+void resetGlyphAtlas() {
+    flushText();
+    submitRenderQueue();
+    glyphCache.clear();
+    for (Character*& ch : asciiGlyphs) ch = nullptr;
+    glyphShelves.clear();
+    glyphShelfBottom = 0;
+    fontGeneration++;
+}
+
+// ===============================
+// Function: hashFile
+// Purpose: Returns the 64-bit FNV-1a hash of a file's contents (0 if it cannot be read).
+// ===============================
+
+uint64_t hashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return 0;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return hashBytes(bytes.data(), bytes.size());
+}
+
+// ===============================
+// Function: ensureFontFace
+// Purpose: Opens FreeType and the font face on demand (skipped entirely on cache hits).
+// Returns: true if the face is ready for rasterization.
+// ===============================
+
+bool ensureFontFace() {
+    if (fontFace) return true;
+    if (!fontLibrary && FT_Init_FreeType(&fontLibrary)) {
+        std::cerr << "ERROR::FREETYPE: Failed to initialize FreeType" << std::endl;
+        fontLibrary = nullptr;
+        return false;
+    }
+    if (FT_New_Face(fontLibrary, fontPath.c_str(), 0, &fontFace)) {
+        std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        fontFace = nullptr;
+        return false;
+    }
+    FT_Set_Pixel_Sizes(fontFace, 0, FONT_PIXEL_SIZE);
+    return true;
+}
+
+// ===============================
+// Function: rasterizeGlyph
+// Purpose: Renders a codepoint with FreeType, converts it to SDF and packs it into the atlas.
+// Returns: The new cache entry (glyphs without pixels get an empty cell).
+// ===============================
+
+Character* rasterizeGlyph(uint32_t codepoint) {
+    Character ch;
+    ch.codepoint = codepoint;
+    if (ensureFontFace() && FT_Load_Char(fontFace, codepoint, FT_LOAD_RENDER) == 0) {
+        FT_GlyphSlot g = fontFace->glyph;
+        ch.size = glm::ivec2(g->bitmap.width, g->bitmap.rows);
+        ch.bearing = glm::ivec2(g->bitmap_left, g->bitmap_top);
+        ch.advance = static_cast<unsigned int>(g->advance.x);
+
+        if (ch.size.x > 0 && ch.size.y > 0) {
+            std::vector<unsigned char> sdf = buildGlyphSdf(g->bitmap.buffer, ch.size.x, ch.size.y,
+                g->bitmap.pitch, ch.cellSize);
+            glm::ivec2 texels = ch.cellSize / FONT_SDF_DOWNSAMPLE;
+            glm::ivec2 pos;
+            bool placed = allocateGlyphRect(texels, pos, ch.shelf);
+            // At most one eviction per shelf; an evicted shelf is as tall as the glyph, so
+            // it only fails to fit if the glyph is wider than the atlas
+            for (size_t pass = glyphShelves.size(); !placed && pass > 0; pass--) {
+                if (!evictColdestShelf(texels.y)) break;
+                placed = allocateGlyphRect(texels, pos, ch.shelf);
+            }
+            if (!placed && !glyphShelves.empty()) {
+                resetGlyphAtlas();
+                placed = allocateGlyphRect(texels, pos, ch.shelf);
+            }
+            if (placed) {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                uploadTexture2D(fontAtlas, pos.x, pos.y, texels.x, texels.y, GL_RED, sdf.data());
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                ch.uvMin = glm::vec2((float)pos.x / FONT_ATLAS_WIDTH, (float)pos.y / FONT_ATLAS_HEIGHT);
+                ch.uvMax = glm::vec2((float)(pos.x + texels.x) / FONT_ATLAS_WIDTH,
+                    (float)(pos.y + texels.y) / FONT_ATLAS_HEIGHT);
+            }
+            else {
+                std::cerr << "Glyph atlas full, cannot draw U+" << std::hex << codepoint << std::dec << std::endl;
+                ch.cellSize = glm::ivec2(0);
+                ch.shelf = -1;
+            }
+        }
+    }
+    else {
+        std::cerr << "ERROR::FREETYPE: Failed to load Glyph U+" << std::hex << codepoint << std::dec << std::endl;
+    }
+
+    Character& entry = glyphCache[glyphKey(codepoint)];
+    entry = ch;
+    if (codepoint < 128) asciiGlyphs[codepoint] = &entry;
+    return &entry;
+}
+
+// ===============================
+// Function: getGlyph
+// Purpose: Returns a glyph from the cache, rasterizing it on first use, and marks it as used.
+// ===============================
+
+const Character* getGlyph(uint32_t codepoint) {
+    Character* ch = nullptr;
+    if (codepoint < 128) {
+        ch = asciiGlyphs[codepoint];
+    }
+    else {
+        auto it = glyphCache.find(glyphKey(codepoint));
+        if (it != glyphCache.end()) ch = &it->second;
+    }
+    if (!ch) ch = rasterizeGlyph(codepoint);
+
+    ch->lastUsed = textFrame;
+    if (ch->shelf >= 0) glyphShelves[ch->shelf].lastUsed = textFrame;
+    return ch;
+}
+
+// ===============================
+// Function: appendTextQuads
+// Purpose: Lays out UTF-8 text with the atlas metrics and appends two triangles per glyph.
+// Parameters: text, x, y (baseline origin), scale, rgba, out - vertex array to append to,
+//             shelves - if given, receives each atlas shelf the quads sample (once each).
+// Returns: Pixel width of the laid-out text (sum of advances).
+// ===============================
+
+float appendTextQuads(const std::string& text, float x, float y, float scale, glm::vec4 rgba,
+    std::vector<TextVertex>& out, std::vector<int>* shelves = nullptr) {
+    float startX = x;
+    for (size_t i = 0; i < text.size();) {
+        const Character& ch = *getGlyph(decodeUtf8(text, i));
+        if (ch.cellSize.x == 0) {
+            x += (ch.advance >> 6) * scale;
+            continue;
+        }
+        // Quad covers the glyph plus the SDF spread on every side
+        float pad = FONT_SDF_SPREAD * FONT_SDF_DOWNSAMPLE * scale;
+        float xpos = x + ch.bearing.x * scale - pad;
+        float ypos = y + (ch.size.y - ch.bearing.y) * scale + pad;
+        float x1 = xpos + ch.cellSize.x * scale;
+        float y1 = ypos - ch.cellSize.y * scale;
+        TextVertex quad[6] = {
+            { glm::vec2(xpos, ypos), glm::vec2(ch.uvMin.x, ch.uvMin.y), rgba },
+            { glm::vec2(x1, ypos),   glm::vec2(ch.uvMax.x, ch.uvMin.y), rgba },
+            { glm::vec2(x1, y1),     glm::vec2(ch.uvMax.x, ch.uvMax.y), rgba },
+            { glm::vec2(xpos, ypos), glm::vec2(ch.uvMin.x, ch.uvMin.y), rgba },
+            { glm::vec2(x1, y1),     glm::vec2(ch.uvMax.x, ch.uvMax.y), rgba },
+            { glm::vec2(xpos, y1),   glm::vec2(ch.uvMin.x, ch.uvMax.y), rgba },
+        };
+        out.insert(out.end(), quad, quad + 6);
+        if (shelves && ch.shelf >= 0 && std::find(shelves->begin(), shelves->end(), ch.shelf) == shelves->end()) {
+            shelves->push_back(ch.shelf);
+        }
+        x += (ch.advance >> 6) * scale;
+    }
+    return x - startX;
+}
+
+// ===============================
+// Function: renderText
+// Purpose: Queues one-off text for drawing with the glyph atlas (drawn by flushText).
+// Parameters: text, x, y, scale, color, alpha.
+// Notes: Lays the string out again on every call; use a TextLabel for text drawn every frame.
+// ===============================
+
+// Function: renderText
+// Purpose: Appends one quad per character to the frame's text batch
+// Parameters:
+//   - text: Text to render
+//   - x, y: Screen coordinates
+//   - scale: Text size multiplier
+//   - color: RGB color values
+//   - alpha: Text opacity (used for the flashing start prompt)
+void renderText(const std::string& text, float x, float y, float scale, glm::vec3 color, float alpha) {
+    TextTimer timer;
+    appendTextQuads(text, x, y, scale, glm::vec4(color.r, color.g, color.b, alpha), textVertices);
+}
+
+// ===============================
+// Function: setLabelText
+// Purpose: Updates a retained label, re-laying it out only if the text, scale or font changed.
+// ===============================
+
+void setLabelText(TextLabel& label, const std::string& text, float scale) {
+    TextTimer timer;
+    if (label.fontGeneration == fontGeneration && label.scale == scale && label.text == text) {
+        return;
+    }
+    label.text = text;
+    label.scale = scale;
+    label.quads.clear();
+    label.shelves.clear();
+    label.width = appendTextQuads(text, 0.0f, 0.0f, scale, glm::vec4(1.0f), label.quads, &label.shelves);
+    label.fontGeneration = fontGeneration;  // After layout: rasterizing may evict and bump it
+}
+
+// ===============================
+// Function: drawLabel
+// Purpose: Queues a retained label's cached quads at (x, y) with the given color.
+// Notes: Re-lays the label out first if the glyph atlas changed underneath it, and marks
+//        its shelves as used so long-lived labels do not look cold to the eviction LRU.
+// ===============================
+
+void drawLabel(TextLabel& label, float x, float y, glm::vec3 color, float alpha = 1.0f) {
+    TextTimer timer;
+    if (label.fontGeneration != fontGeneration) {
+        // Atlas changed since the label was laid out (glyphs evicted or font reloaded)
+        std::string text = label.text;
+        label.text.clear();
+        setLabelText(label, text, label.scale);
+    }
+    for (int shelf : label.shelves) {
+        if (shelf < (int)glyphShelves.size()) glyphShelves[shelf].lastUsed = textFrame;  // Atlas may have been reset
+    }
+    glm::vec2 offset(x, y);
+    glm::vec4 rgba(color.r, color.g, color.b, alpha);
+    size_t first = textVertices.size();
+    textVertices.insert(textVertices.end(), label.quads.begin(), label.quads.end());
+    for (size_t i = first; i < textVertices.size(); i++) {
+        textVertices[i].pos = textVertices[i].pos + offset;
+        textVertices[i].color = rgba;
+    }
+}
+
+// ===============================
+// Function: flushText
+// Purpose: Uploads every queued text quad of the frame and queues them as a single draw.
+// Notes: Called once per frame, after the screen's background and 3D pass.
+// ===============================
+
+void flushText() {
+    if (textVertices.empty()) return;
+    TextTimer timer;
+    if (renderQueueUses(textVao)) submitRenderQueue();  // The buffer is about to be refilled
+
+    // Orphan the buffer so the driver never waits on last frame's text
+    glBindBuffer(GL_ARRAY_BUFFER, textVbo);
+    size_t bytes = textVertices.size() * sizeof(TextVertex);
+    if (bytes > textVboCapacity) {
+        textVboCapacity = bytes * 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, textVboCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, textVertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderPacket packet;
+    packet.key = renderKey(RENDER_LAYER_TEXT, 0, textProgram.id, fontAtlas, textVao);
+    packet.program = textProgram.id;
+    packet.texture = fontAtlas;
+    packet.vao = textVao;
+    packet.blend = true;
+    packet.count = (GLsizei)textVertices.size();
+    renderQueue.push_back(packet);
+
+    textVertices.clear();
+}
+
+// ===============================
+// Function: endTextFrame
+// Purpose: Advances the glyph LRU clock and, with --text-stats, prints the average
+//          per-frame text CPU time every 600 frames.
+// ===============================
+
+void endTextFrame() {
+    textFrame++;
+    if (!showTextStats) return;
+    if (++textStatsFrames >= 600) {
+        std::cout << "Text CPU: " << textCpuMs / textStatsFrames << " ms/frame" << std::endl;
+        textCpuMs = 0.0;
+        textStatsFrames = 0;
+    }
+}
+// ===============================
+// Function: initProfiler
+// Purpose: Creates the timer queries and, if requested, opens the CSV log.
+// Parameters: csvPath - file for per-frame timings (empty = no log).
+// ===============================
+
+void initProfiler(const std::string& csvPath) {
+    glGenQueries(2 * PHASE_COUNT, &profiler.queries[0][0]);
+    profiler.gpuTimers = true;
+    if (csvPath.empty()) return;
+
+    profiler.csv.open(csvPath);
+    if (!profiler.csv) {
+        std::cerr << "Could not open profile log " << csvPath << std::endl;
+        return;
+    }
+    profiler.csv << "frame";
+    for (int p = 0; p < PHASE_COUNT; p++) profiler.csv << ",cpu_" << PROFILE_PHASE_NAMES[p] << "_ms";
+    for (int p = 0; p < PHASE_COUNT; p++) profiler.csv << ",gpu_" << PROFILE_PHASE_NAMES[p] << "_ms";
+    profiler.csv << "\n";
+}
+
+// ===============================
+// Function: endProfilerFrame
+// Purpose: Closes the frame: reads the previous frame's GPU timers, records that frame in
+//          the rolling history and CSV log, then swaps query sets.
+// Notes: A query that is not finished yet is reported as -1 rather than waited on.
+// ===============================
+
+void endProfilerFrame() {
+    int previous = 1 - profiler.set;
+    if (profiler.frame > 0) {
+        int slot = profiler.historyNext;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            float gpuMs = -1.0f;
+            if (profiler.issued[previous][p]) {
+                GLint available = 0;
+                glGetQueryObjectiv(profiler.queries[previous][p], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint64 ns = 0;
+                    glGetQueryObjectui64v(profiler.queries[previous][p], GL_QUERY_RESULT, &ns);
+                    gpuMs = ns / 1.0e6f;
+                }
+            }
+            profiler.cpuHistory[p][slot] = (float)profiler.cpuPrevious[p];
+            profiler.gpuHistory[p][slot] = gpuMs;
+        }
+        profiler.historyNext = (slot + 1) % PROFILE_HISTORY;
+        profiler.historyCount = std::min(profiler.historyCount + 1, PROFILE_HISTORY);
+
+        if (profiler.csv.is_open()) {
+            profiler.csv << profiler.frame - 1;
+            for (int p = 0; p < PHASE_COUNT; p++) profiler.csv << "," << profiler.cpuHistory[p][slot];
+            for (int p = 0; p < PHASE_COUNT; p++) profiler.csv << "," << profiler.gpuHistory[p][slot];
+            profiler.csv << "\n";
+        }
+    }
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        profiler.cpuPrevious[p] = profiler.cpuFrame[p];
+        profiler.cpuFrame[p] = 0.0;
+        profiler.issued[previous][p] = false;
+    }
+    profiler.set = previous;
+    profiler.frame++;
+}
+
+// ===============================
+// Function: drawProfilerOverlay
+// Purpose: Queues the rolling average and maximum of every phase as text (F3 toggles).
+// ===============================
+
+void drawProfilerOverlay() {
+    if (!showProfiler || profiler.historyCount == 0) return;
+    float y = HEIGHT - 150;
+    renderText("PHASE    CPU AVG/MAX   GPU AVG/MAX (MS)", 40, y, 0.3f, { 1,1,0 });
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        float cpuSum = 0.0f, cpuMax = 0.0f, gpuSum = 0.0f, gpuMax = 0.0f;
+        int gpuCount = 0;
+        for (int i = 0; i < profiler.historyCount; i++) {
+            cpuSum += profiler.cpuHistory[p][i];
+            cpuMax = std::max(cpuMax, profiler.cpuHistory[p][i]);
+            if (profiler.gpuHistory[p][i] >= 0.0f) {
+                gpuSum += profiler.gpuHistory[p][i];
+                gpuMax = std::max(gpuMax, profiler.gpuHistory[p][i]);
+                gpuCount++;
+            }
+        }
+        std::string name = PROFILE_PHASE_NAMES[p];
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);  // The font is upper case only
+        char line[96];
+        if (gpuCount > 0) {
+            snprintf(line, sizeof(line), "%-8s %6.2f/%6.2f  %6.2f/%6.2f", name.c_str(),
+                cpuSum / profiler.historyCount, cpuMax, gpuSum / gpuCount, gpuMax);
+        }
+        else {
+            snprintf(line, sizeof(line), "%-8s %6.2f/%6.2f       -", name.c_str(),
+                cpuSum / profiler.historyCount, cpuMax);
+        }
+        y -= 24;
+        renderText(line, 40, y, 0.3f, { 1,1,0 });
+    }
+    if (useDynamicResolution) {
+        char line[64];
+        snprintf(line, sizeof(line), "MODEL SCALE %3d%%", (int)std::lround(dynamicResolution.scale * 100.0f));
+        renderText(line, 40, y - 24, 0.3f, { 1,1,0 });
+    }
+}
+
+// ===============================
+// Function: captureWorker
+// Purpose: Background thread that encodes queued captures as PNG files.
+// ===============================
+
+void captureWorker() {
+    for (;;) {
+        CaptureJob job;
+        {
+            std::unique_lock<std::mutex> lock(frameCapture.mutex);
+            frameCapture.wake.wait(lock, [] { return frameCapture.stopping || !frameCapture.jobs.empty(); });
+            if (frameCapture.jobs.empty()) return;  // Stopping, and everything is written
+            job = std::move(frameCapture.jobs.front());
+            frameCapture.jobs.pop_front();
+        }
+        // The back buffer's alpha is whatever the last blend left; screenshots should be opaque
+        for (size_t i = 3; i < job.pixels.size(); i += 4) job.pixels[i] = 255;
+        if (!stbi_write_png(job.path.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4)) {
+            std::cerr << "Could not write capture " << job.path << std::endl;
+        }
+        else if (job.announce) {
+            std::cout << "Saved " << job.path << std::endl;
+        }
+    }
+}
+
+// ===============================
+// Function: stopCaptureWorker
+// Purpose: Lets the encoder write every queued capture and joins it.
+// Notes: Also registered with atexit, since exit() from the GLUT loop skips cleanup and a
+//        joinable std::thread must not be destroyed.
+// ===============================
+
+void stopCaptureWorker() {
+    if (!frameCapture.worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(frameCapture.mutex);
+        frameCapture.stopping = true;
+    }
+    frameCapture.wake.notify_one();
+    frameCapture.worker.join();
+}
+
+// ===============================
+// Function: initFrameCapture
+// Purpose: Creates the pixel-pack buffer ring and starts the encoder thread (on first capture).
+// ===============================
+
+void initFrameCapture() {
+    if (frameCapture.worker.joinable()) return;
+    std::error_code error;
+    std::filesystem::create_directories(captureDir, error);
+    for (CaptureSlot& slot : frameCapture.slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)WIDTH * HEIGHT * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    stbi_flip_vertically_on_write(1);  // GL rows start at the bottom
+    frameCapture.worker = std::thread(captureWorker);
+    std::atexit(stopCaptureWorker);
+}
+
+// ===============================
+// Function: captureTimestamp
+// Purpose: Returns the local time as YYYYMMDD_HHMMSS for capture file names.
+// ===============================
+
+std::string captureTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+    return stamp;
+}
+
+// ===============================
+// Function: captureFrame
+// Purpose: Starts an asynchronous readback of the finished frame if a capture is pending.
+// Notes: Call before the swap. glReadPixels targets a pixel-pack buffer, so it returns at
+//        once; a fence marks when the copy is done. If every slot is still in flight the
+//        frame is dropped rather than waited for.
+// ===============================
+
+void captureFrame() {
+    if (!frameCapture.screenshotRequested && frameCapture.sequenceRemaining == 0) return;
+    initFrameCapture();
+
+    CaptureSlot& slot = frameCapture.slots[frameCapture.next];
+    if (slot.fence) {
+        frameCapture.dropped++;
+        return;
+    }
+    if (frameCapture.screenshotRequested) {
+        slot.path = captureDir + "/screenshot_" + captureTimestamp() + ".png";
+        slot.announce = true;
+        frameCapture.screenshotRequested = false;
+    }
+    else {
+        char name[32];
+        snprintf(name, sizeof(name), "_%04d.png", frameCapture.sequenceFrame++);
+        slot.path = frameCapture.sequenceName + name;
+        slot.announce = false;
+        if (--frameCapture.sequenceRemaining == 0) {
+            std::cout << "Captured " << frameCapture.sequenceFrame << " frames to " << frameCapture.sequenceName
+                << "_*.png (" << frameCapture.dropped << " dropped)" << std::endl;
+        }
+    }
+
+    submitRenderQueue();  // Everything queued must be in the frame being read
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, screenFramebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameCapture.next = (frameCapture.next + 1) % CAPTURE_SLOTS;
+}
+
+// ===============================
+// Function: collectCaptures
+// Purpose: Hands finished readbacks to the encoder thread.
+// Parameters: wait - block until every readback is done (only used at exit).
+// Notes: Without wait a slot whose fence has not signalled is left for a later frame, so
+//        mapping never stalls the render thread.
+// ===============================
+
+void collectCaptures(bool wait = false) {
+    for (CaptureSlot& slot : frameCapture.slots) {
+        if (!slot.fence) continue;
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+            wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        CaptureJob job;
+        job.path = slot.path;
+        job.width = WIDTH;
+        job.height = HEIGHT;
+        job.announce = slot.announce;
+        job.pixels.resize((size_t)WIDTH * HEIGHT * 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, job.pixels.size(), GL_MAP_READ_BIT);
+        if (mapped) {
+            memcpy(job.pixels.data(), mapped, job.pixels.size());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!mapped) continue;
+        {
+            std::lock_guard<std::mutex> lock(frameCapture.mutex);
+            frameCapture.jobs.push_back(std::move(job));
+        }
+        frameCapture.wake.notify_one();
+    }
+}
+
+// ===============================
+// Function: shutdownFrameCapture
+// Purpose: Finishes pending captures, waits for the encoder and frees the readback ring.
+// Notes: Leaves the capture state as initFrameCapture expects it, so capturing can start again.
+// ===============================
+
+void shutdownFrameCapture() {
+    if (!frameCapture.worker.joinable()) return;
+    collectCaptures(true);
+    stopCaptureWorker();
+    for (CaptureSlot& slot : frameCapture.slots) {
+        glDeleteBuffers(1, &slot.pbo);
+        slot.pbo = 0;
+        if (slot.fence) glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    frameCapture.next = 0;
+    frameCapture.stopping = false;
+}
+
+// ===============================
+// Function: specialKeys
+// Purpose: Handles function keys (F3 toggles the profiler overlay, F11 starts or stops a
+//          frame sequence capture, F12 takes a screenshot).
+// ===============================
+
+void specialKeys(int key, int /*x*/, int /*y*/) {
+    if (key == GLUT_KEY_F3) showProfiler = !showProfiler;
+    if (key == GLUT_KEY_F12) frameCapture.screenshotRequested = true;
+    if (key == GLUT_KEY_F11) {
+        if (frameCapture.sequenceRemaining > 0) {
+            std::cout << "Sequence capture stopped after " << frameCapture.sequenceFrame << " frames ("
+                << frameCapture.dropped << " dropped)" << std::endl;
+            frameCapture.sequenceRemaining = 0;
+        }
+        else {
+            frameCapture.sequenceName = captureDir + "/sequence_" + captureTimestamp();
+            frameCapture.sequenceRemaining = captureSequenceFrames;
+            frameCapture.sequenceFrame = 0;
+            frameCapture.dropped = 0;
+        }
+    }
+}
+
+// ===============================
+// Function: drawCachedLayer
+// Purpose: Draws static 2D content through an offscreen layer and composites it with one blit.
+// Parameters: layer - cache to use, key - everything the content depends on (a change
+//             triggers a redraw), draw - queues the sprites and labels of the layer.
+// Notes: The layer is only re-rendered when its key or the font generation changes.
+//        With --no-layer-cache (or no usable FBO) the content is queued directly instead.
+// ===============================
+
+void drawCachedLayer(CachedLayer& layer, const std::string& key, const std::function<void()>& draw) {
+    ProfileScope scope(PHASE_LAYERS);
+    if (useCachedLayers && layer.fbo == 0) {
+        glGenTextures(1, &layer.color);
+        glBindTexture(GL_TEXTURE_2D, layer.color);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glGenFramebuffers(1, &layer.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.color, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Layer framebuffer incomplete, drawing static layers every frame" << std::endl;
+            useCachedLayers = false;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    }
+    if (!useCachedLayers) {
+        draw();
+        flushSprites(RENDER_LAYER_BACKGROUND);
+        submitRenderQueue();  // Immediate draws (impostors) that follow must land on top
+        return;
+    }
+
+    if (!layer.valid || layer.key != key || layer.fontGeneration != fontGeneration) {
+        // Anything already queued belongs to the window, not the layer
+        flushSprites();
+        flushText();
+        submitRenderQueue();
+        glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+        glViewport(0, 0, WIDTH, HEIGHT);
+        const GLfloat black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        glClearBufferfv(GL_COLOR, 0, black);  // Leaves the screen's clear colour alone
+        draw();
+        flushSprites();
+        flushText();
+        submitRenderQueue();
+        glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+        layer.key = key;
+        layer.fontGeneration = fontGeneration;
+        layer.valid = true;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, layer.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, screenFramebuffer);
+    glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+}
+
+
+// ===============================
+// Function: createFontAtlas
+// Purpose: Creates the SDF atlas texture on first use and fills it from an R8 image,
+//          or clears it if pixels is null.
+// ===============================
+
+void createFontAtlas(const unsigned char* pixels) {
+    std::vector<unsigned char> blank;
+    if (!pixels) {
+        blank.assign((size_t)FONT_ATLAS_WIDTH * FONT_ATLAS_HEIGHT, 0);
+        pixels = blank.data();
+    }
+    // The atlas size is fixed, so a reload only replaces the contents of the same storage
+    if (fontAtlas == 0) fontAtlas = createTexture2D(GL_R8, FONT_ATLAS_WIDTH, FONT_ATLAS_HEIGHT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uploadTexture2D(fontAtlas, 0, 0, FONT_ATLAS_WIDTH, FONT_ATLAS_HEIGHT, GL_RED, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    setTextureSampling(fontAtlas, GL_CLAMP_TO_EDGE, GL_LINEAR);
+}
+
+// ===============================
+// Function: saveFontCache
+// Purpose: Writes the current atlas image, shelves and glyph metrics to the font cache file.
+// ===============================
+
+void saveFontCache() {
+    FontCacheHeader header;
+    header.fontHash = fontFileHash;
+    header.glyphCount = (int32_t)glyphCache.size();
+    header.shelfCount = (int32_t)glyphShelves.size();
+    header.shelfBottom = glyphShelfBottom;
+
+    std::vector<unsigned char> atlas((size_t)FONT_ATLAS_WIDTH * FONT_ATLAS_HEIGHT);
+    glBindTexture(GL_TEXTURE_2D, fontAtlas);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    std::string cachePath = fontPath + FONT_CACHE_SUFFIX;
+    std::ofstream out(cachePath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Could not write font cache " << cachePath << std::endl;
+        return;
+    }
+    out.write((const char*)&header, sizeof(header));
+    for (const GlyphShelf& shelf : glyphShelves) {
+        FontCacheShelf record = { shelf.y, shelf.height, shelf.x };
+        out.write((const char*)&record, sizeof(record));
+    }
+    for (const auto& pair : glyphCache) {
+        const Character& ch = pair.second;
+        FontCacheGlyph record = {
+            ch.codepoint, ch.size.x, ch.size.y, ch.bearing.x, ch.bearing.y,
+            ch.cellSize.x, ch.cellSize.y, ch.shelf, ch.advance,
+            ch.uvMin.x, ch.uvMin.y, ch.uvMax.x, ch.uvMax.y
+        };
+        out.write((const char*)&record, sizeof(record));
+    }
+    out.write((const char*)atlas.data(), atlas.size());
+    std::cout << "Font cache written to " << cachePath << std::endl;
+}
+
+// ===============================
+// Function: loadFontCache
+// Purpose: Restores the glyph cache and atlas from the font cache file with a single read.
+// Returns: false if the file is missing or was built for another font, size or version.
+// ===============================
+
+bool loadFontCache() {
+    std::ifstream in(fontPath + FONT_CACHE_SUFFIX, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::vector<char> data((size_t)in.tellg());
+    in.seekg(0);
+    in.read(data.data(), data.size());
+    if (!in || data.size() < sizeof(FontCacheHeader)) return false;
+
+    FontCacheHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    FontCacheHeader expected;
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.fontHash != fontFileHash || header.pixelSize != expected.pixelSize ||
+        header.sdfDownsample != expected.sdfDownsample || header.sdfSpread != expected.sdfSpread ||
+        header.atlasWidth != expected.atlasWidth || header.atlasHeight != expected.atlasHeight) {
+        std::cout << "Font cache is stale, rebuilding it" << std::endl;
+        return false;
+    }
+    size_t expectedSize = sizeof(header) + header.shelfCount * sizeof(FontCacheShelf) +
+        header.glyphCount * sizeof(FontCacheGlyph) + (size_t)FONT_ATLAS_WIDTH * FONT_ATLAS_HEIGHT;
+    if (header.shelfCount < 0 || header.glyphCount < 0 || data.size() != expectedSize) return false;
+
+    const char* cursor = data.data() + sizeof(header);
+    for (int32_t i = 0; i < header.shelfCount; i++) {
+        FontCacheShelf record;
+        memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+        GlyphShelf shelf;
+        shelf.y = record.y;
+        shelf.height = record.height;
+        shelf.x = record.x;
+        glyphShelves.push_back(shelf);
+    }
+    glyphShelfBottom = header.shelfBottom;
+    for (int32_t i = 0; i < header.glyphCount; i++) {
+        FontCacheGlyph record;
+        memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+        Character& ch = glyphCache[glyphKey(record.codepoint)];
+        ch.codepoint = record.codepoint;
+        ch.size = glm::ivec2(record.sizeX, record.sizeY);
+        ch.bearing = glm::ivec2(record.bearingX, record.bearingY);
+        ch.cellSize = glm::ivec2(record.cellX, record.cellY);
+        ch.shelf = record.shelf;
+        ch.advance = record.advance;
+        ch.uvMin = glm::vec2(record.uvMinX, record.uvMinY);
+        ch.uvMax = glm::vec2(record.uvMaxX, record.uvMaxY);
+        if (ch.codepoint < 128) asciiGlyphs[ch.codepoint] = &ch;
+    }
+    createFontAtlas((const unsigned char*)cursor);
+    return true;
+}
+
+// ===============================
+// Function: loadFont
+// Purpose: Sets up the glyph cache and SDF atlas for a font, from the disk cache when possible.
+// Parameters: path - path to the .ttf font file.
+// Notes: On a cache hit FreeType is not touched at startup; it is opened later only if a
+//        glyph outside the cache is drawn. On a miss the printable ASCII range is
+//        rasterized and the cache file is written for the next launch.
+// ===============================
+
+void loadFont(const char* path) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (fontFace) {
+        FT_Done_Face(fontFace);
+        fontFace = nullptr;
+    }
+    fontPath = path;
+    fontFileHash = hashFile(fontPath);
+    if (fontFileHash == 0) {
+        std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        return;
+    }
+
+    // Clear existing glyphs
+    fontLoaded = false;
+    fontGeneration++;
+    glyphCache.clear();
+    for (Character*& ch : asciiGlyphs) ch = nullptr;
+    glyphShelves.clear();
+    glyphShelfBottom = 0;
+
+    bool fromCache = loadFontCache();
+    if (!fromCache) {
+        glyphCache.clear();
+        for (Character*& ch : asciiGlyphs) ch = nullptr;
+        glyphShelves.clear();
+        glyphShelfBottom = 0;
+        createFontAtlas(nullptr);
+        if (!ensureFontFace()) return;
+        // Warm the printable ASCII range so the UI never rasterizes on a cache hit
+        for (uint32_t c = 32; c < 127; c++) getGlyph(c);
+        saveFontCache();
+    }
+
+    // Verify font loading
+    fontLoaded = getGlyph('A')->cellSize.x > 0;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    if (!fontLoaded) {
+        std::cerr << "ERROR::FREETYPE: Font loading verification failed" << std::endl;
+    }
+    else {
+        std::cout << "Font loaded successfully in " << ms << " ms ("
+            << (fromCache ? "atlas cache" : "FreeType") << ", " << glyphCache.size() << " glyphs)" << std::endl;
+    }
+}
+
+// ===============================
+// Function: initSound
+// Purpose: Loads all sound files and initializes OpenAL sources for BGM and SFX.
+// ===============================
+
+void initSound() {
+    alDevice = alcOpenDevice(nullptr);
+    alContext = alcCreateContext(alDevice, nullptr);
+    alcMakeContextCurrent(alContext);
+
+    auto loadSound = [](const char* path) -> ALuint {
+        drwav wav;
+        if (!drwav_init_file(&wav, path, nullptr)) return 0;
+
+        std::vector<int16_t> pcmData(wav.totalPCMFrameCount * wav.channels);
+        drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, pcmData.data());
+
+        ALuint buffer;
+        alGenBuffers(1, &buffer);
+        alBufferData(buffer, wav.channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16,
+            pcmData.data(), pcmData.size() * sizeof(int16_t), wav.sampleRate);
+
+        drwav_uninit(&wav);
+        return buffer;
+        };
+
+    ALuint bgmBuffer = loadSound("assets/sounds/bgm.wav");
+    ALuint successBuffer = loadSound("assets/sounds/success.wav");
+    ALuint failureBuffer = loadSound("assets/sounds/failure.wav");
+    ALuint gameBgmBuffer = loadSound("assets/sounds/guess_bgm.wav");
+    ALuint gameOverBuffer = loadSound("assets/sounds/game_over.wav");
+    ALuint winnerBgmBuffer = loadSound("assets/sounds/winner_bgm.wav");
+
+    alGenSources(1, &bgmSource);
+    alSourcei(bgmSource, AL_BUFFER, bgmBuffer);
+    alSourcei(bgmSource, AL_LOOPING, AL_TRUE);
+
+    alGenSources(1, &gameBgmSource);
+    alSourcei(gameBgmSource, AL_BUFFER, gameBgmBuffer);
+    alSourcei(gameBgmSource, AL_LOOPING, AL_TRUE);
+
+    alGenSources(1, &successSource);
+    alSourcei(successSource, AL_BUFFER, successBuffer);
+
+    alGenSources(1, &failureSource);
+    alSourcei(failureSource, AL_BUFFER, failureBuffer);
+
+    alGenSources(1, &gameOverSource);
+    alSourcei(gameOverSource, AL_BUFFER, gameOverBuffer);
+
+    alGenSources(1, &winnerBgmSource);
+    alSourcei(winnerBgmSource, AL_BUFFER, winnerBgmBuffer);
+    alSourcei(winnerBgmSource, AL_LOOPING, AL_TRUE);
+
+    alSourcePlay(bgmSource);
+}
+
+// Assimp post-processing used for every model (the manifest must match what loadModel sees)
+const unsigned int MODEL_IMPORT_FLAGS =
+    aiProcess_Triangulate |
+    aiProcess_GenNormals |
+    aiProcess_CalcTangentSpace |
+    aiProcess_JoinIdenticalVertices |
+    aiProcess_SortByPType;
+
+// ===============================
+// Function: modelBasePath
+// Purpose: Returns the asset folder for a Pokémon, e.g. "assets/models/025/".
+// ===============================
+
+std::string modelBasePath(int id) {
+    std::string folder = std::to_string(id);
+    folder = std::string(3 - folder.length(), '0') + folder;
+    return "assets/models/" + folder + "/";
+}
+
+// ===============================
+// Function: diffuseTexturePath
+// Purpose: Resolves a material's diffuse texture to a file inside the model folder.
+// Returns: Full path, or an empty string when the material has no diffuse texture.
+// ===============================
+
+std::string diffuseTexturePath(const aiMaterial* material, const std::string& basePath) {
+    aiString texPath;
+    if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) != AI_SUCCESS) {
+        return "";
+    }
+    std::string texFile = texPath.C_Str();
+    size_t lastSlash = texFile.find_last_of("/\\");
+    if (lastSlash != std::string::npos) {
+        texFile = texFile.substr(lastSlash + 1);
+    }
+    return basePath + texFile;
+}
+
+// ===============================
+// Function: buildAssetManifest
+// Purpose: Parses every model (1-151) and writes the binary manifest plus a readable dump.
+// Notes: Run with --build-manifest whenever assets/models changes. Needs no GL context.
+//        GPU bytes = positions/texcoords/normals + 32-bit indices + RGBA textures with mips.
+//        CPU bytes = Assimp scene kept by ModelData (5 aiVector3D streams per vertex)
+//        + index copies + decoded images.
+// ===============================
+
+void buildAssetManifest() {
+    std::vector<ModelManifestEntry> entries;
+    for (int id = 1; id <= 151; id++) {
+        std::string basePath = modelBasePath(id);
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(basePath + "model.obj", MODEL_IMPORT_FLAGS);
+        if (!scene) {
+            std::cerr << "Manifest: skipping " << id << ": " << importer.GetErrorString() << std::endl;
+            continue;
+        }
+
+        ModelManifestEntry entry;
+        entry.id = id;
+        entry.meshCount = scene->mNumMeshes;
+        entry.materialCount = scene->mNumMaterials;
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+            const aiMesh* mesh = scene->mMeshes[i];
+            entry.vertexCount += mesh->mNumVertices;
+            for (unsigned int j = 0; j < mesh->mNumFaces; j++) {
+                entry.indexCount += mesh->mFaces[j].mNumIndices;
+            }
+        }
+
+        uint64_t textureBytes = 0;
+        for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+            glm::ivec2 texSize(0, 0);
+            std::string texPath = diffuseTexturePath(scene->mMaterials[i], basePath);
+            int ch;
+            if (!texPath.empty() && stbi_info(texPath.c_str(), &texSize.x, &texSize.y, &ch)) {
+                textureBytes += (uint64_t)texSize.x * texSize.y * 4;
+            }
+            entry.textureSizes.push_back(texSize);
+        }
+
+        uint64_t vertexBytes = (uint64_t)entry.vertexCount * (sizeof(glm::vec3) * 2 + sizeof(glm::vec2));
+        uint64_t indexBytes = (uint64_t)entry.indexCount * sizeof(unsigned int);
+        entry.gpuBytes = vertexBytes + indexBytes + textureBytes * 4 / 3;
+        entry.cpuBytes = (uint64_t)entry.vertexCount * sizeof(aiVector3D) * 5 + indexBytes * 2 + textureBytes;
+        entries.push_back(entry);
+    }
+
+    std::ofstream bin(MANIFEST_BIN_PATH, std::ios::binary);
+    uint32_t count = (uint32_t)entries.size();
+    bin.write((const char*)&MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+    bin.write((const char*)&MANIFEST_VERSION, sizeof(MANIFEST_VERSION));
+    bin.write((const char*)&count, sizeof(count));
+    for (const ModelManifestEntry& e : entries) {
+        uint32_t fields[5] = { e.id, e.meshCount, e.vertexCount, e.indexCount, e.materialCount };
+        bin.write((const char*)fields, sizeof(fields));
+        bin.write((const char*)&e.cpuBytes, sizeof(e.cpuBytes));
+        bin.write((const char*)&e.gpuBytes, sizeof(e.gpuBytes));
+        for (const glm::ivec2& t : e.textureSizes) {
+            int32_t dims[2] = { t.x, t.y };
+            bin.write((const char*)dims, sizeof(dims));
+        }
+    }
+
+    std::ofstream txt(MANIFEST_TXT_PATH);
+    txt << "# id name meshes vertices indices materials cpu_kb gpu_kb textures\n";
+    for (const ModelManifestEntry& e : entries) {
+        txt << e.id << " " << pokemonNames[e.id] << " " << e.meshCount << " " << e.vertexCount << " "
+            << e.indexCount << " " << e.materialCount << " " << e.cpuBytes / 1024 << " "
+            << e.gpuBytes / 1024 << " ";
+        for (const glm::ivec2& t : e.textureSizes) txt << t.x << "x" << t.y << " ";
+        txt << "\n";
+    }
+    std::cout << "Manifest written for " << entries.size() << " models to " << MANIFEST_BIN_PATH
+        << " and " << MANIFEST_TXT_PATH << std::endl;
+}
+
+// ===============================
+// Function: loadAssetManifest
+// Purpose: Reads the binary manifest into modelManifest (missing or stale files are ignored).
+// ===============================
+
+void loadAssetManifest() {
+    std::ifstream bin(MANIFEST_BIN_PATH, std::ios::binary);
+    if (!bin) {
+        std::cout << "No asset manifest found (run with --build-manifest to generate one)" << std::endl;
+        return;
+    }
+    uint32_t magic = 0, version = 0, count = 0;
+    bin.read((char*)&magic, sizeof(magic));
+    bin.read((char*)&version, sizeof(version));
+    bin.read((char*)&count, sizeof(count));
+    if (!bin || magic != MANIFEST_MAGIC || version != MANIFEST_VERSION) {
+        std::cerr << "Asset manifest is invalid or out of date, ignoring it" << std::endl;
+        return;
+    }
+    modelManifest.clear();
+    for (uint32_t n = 0; n < count; n++) {
+        ModelManifestEntry e;
+        uint32_t fields[5];
+        bin.read((char*)fields, sizeof(fields));
+        bin.read((char*)&e.cpuBytes, sizeof(e.cpuBytes));
+        bin.read((char*)&e.gpuBytes, sizeof(e.gpuBytes));
+        if (!bin) break;
+        e.id = fields[0];
+        e.meshCount = fields[1];
+        e.vertexCount = fields[2];
+        e.indexCount = fields[3];
+        e.materialCount = fields[4];
+        for (uint32_t t = 0; t < e.materialCount; t++) {
+            int32_t dims[2] = { 0, 0 };
+            bin.read((char*)dims, sizeof(dims));
+            e.textureSizes.push_back(glm::ivec2(dims[0], dims[1]));
+        }
+        if (!bin) break;
+        modelManifest[e.id] = std::move(e);
+    }
+    std::cout << "Asset manifest loaded: " << modelManifest.size() << " models" << std::endl;
+}
+
+// ===============================
+// Function: decodeTextureFile
+// Purpose: Decodes an image file on the calling (worker) thread and leaves it ready to upload.
+// Parameters: slot - ring slot reserved for this image by the render thread, or -1.
+// Returns: The image in its slot (flipped to bottom-up rows), or in stbi memory flipped in
+//          place when there was no slot or it is too small; no pixels if the file could
+//          not be read (the slot is then still reserved and must be released).
+// ===============================
+
+DecodedTexture decodeTextureFile(const std::string& path, int slot) {
+    auto start = std::chrono::high_resolution_clock::now();
+    DecodedTexture image;
+    int ch;
+    unsigned char* pixels = stbi_load(path.c_str(), &image.w, &image.h, &ch, 4);
+    if (pixels && slot >= 0 && (size_t)image.w * image.h * 4 <= PBO_RING_SLOT_BYTES) {
+        writeImageToPboSlot(slot, pixels, image.w, image.h);
+        stbi_image_free(pixels);
+        image.slot = slot;
+    }
+    else if (pixels) {
+        flipImageRows(pixels, image.w, image.h);
+        image.pixels = pixels;
+    }
+    image.decodeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    return image;
+}
+
+// ===============================
+// Function: startModelStream
+// Purpose: Starts phase two of a model load: texcoords, normals and diffuse textures are
+//          prepared on worker threads while the silhouette is already on screen.
+// Parameters: id - model being streamed, texturePaths - diffuse texture per material,
+//             start - time loadModel began (for the time-to-full-model report).
+// ===============================
+
+void startModelStream(int id, const std::vector<std::string>& texturePaths,
+    std::chrono::high_resolution_clock::time_point start) {
+    const aiScene* scene = pokemonModels[id].scene;
+    modelStream.id = id;
+    modelStream.active = true;
+    modelStream.start = start;
+    modelStream.texturePaths = texturePaths;
+    modelStream.nextTexture = 0;
+    modelStream.attributesUploaded = false;
+    textureUploadStallMs = 0.0;
+
+    stbi_set_flip_vertically_on_load(false);  // Rows are flipped while uploading
+    modelStream.textures.clear();
+    modelStream.textures.resize(texturePaths.size());
+    modelStream.slots.assign(texturePaths.size(), -1);
+
+    // Manifest sizes (when the entry matches this scene) keep textures that cannot fit a ring
+    // slot, or will not load, from holding one that another texture could use
+    const std::vector<glm::ivec2>* plannedSizes = nullptr;
+    auto manifestIt = modelManifest.find(id);
+    if (manifestIt != modelManifest.end() && manifestIt->second.materialCount == scene->mNumMaterials &&
+        manifestIt->second.textureSizes.size() == texturePaths.size()) {
+        plannedSizes = &manifestIt->second.textureSizes;
+    }
+    for (size_t i = 0; i < texturePaths.size(); i++) {
+        if (texturePaths[i].empty()) continue;
+        bool fitsSlot = true;
+        if (plannedSizes) {
+            glm::ivec2 size = (*plannedSizes)[i];
+            fitsSlot = size.x > 0 && size.y > 0 && (size_t)size.x * size.y * 4 <= PBO_RING_SLOT_BYTES;
+        }
+        // Workers decode straight into a reserved slot; without a free one they fall back to memory
+        modelStream.slots[i] = fitsSlot ? tryAcquirePboSlot() : -1;
+        modelStream.textures[i] = std::async(std::launch::async, decodeTextureFile, texturePaths[i],
+            modelStream.slots[i]);
+    }
+
+    // The importer owns the scene and outlives the job (cancelModelStream waits for it)
+    modelStream.attributes = std::async(std::launch::async, [scene]() {
+        std::vector<MeshAttributes> attributes(scene->mNumMeshes);
+        for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+            aiMesh* mesh = scene->mMeshes[i];
+            MeshAttributes& out = attributes[i];
+            out.texCoords.reserve(mesh->HasTextureCoords(0) ? mesh->mNumVertices : 0);
+            out.normals.reserve(mesh->HasNormals() ? mesh->mNumVertices : 0);
+            for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
+                if (mesh->HasNormals())
+                    out.normals.emplace_back(mesh->mNormals[j].x, mesh->mNormals[j].y, mesh->mNormals[j].z);
+                if (mesh->HasTextureCoords(0))
+                    out.texCoords.emplace_back(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
+            }
+        }
+        return attributes;
+        });
+}
+
+// ===============================
+// Function: uploadModelAttributes
+// Purpose: Attaches streamed texcoord (location 1) and normal (location 2) buffers to each mesh VAO.
+// ===============================
+
+void uploadModelAttributes(ModelData& modelData, const std::vector<MeshAttributes>& attributes) {
+    for (size_t i = 0; i < modelData.meshes.size() && i < attributes.size(); i++) {
+        MeshData& meshData = modelData.meshes[i];
+        // TBO (texcoords)
+        meshData.tbo = createStaticBuffer(attributes[i].texCoords.size() * sizeof(glm::vec2),
+            attributes[i].texCoords.data());
+        attachVertexBuffer(meshData.vao, 1, meshData.tbo, 2);
+        // NBO (normals)
+        meshData.nbo = createStaticBuffer(attributes[i].normals.size() * sizeof(glm::vec3),
+            attributes[i].normals.data());
+        attachVertexBuffer(meshData.vao, 2, meshData.nbo, 3);
+    }
+}
+
+// ===============================
+// Function: pumpModelStream
+// Purpose: Moves finished phase-two work onto the GPU.
+// Parameters: wait - block until everything is uploaded (used before the colour reveal);
+//             otherwise only work that is already decoded is taken, one texture per call.
+// ===============================
+
+void pumpModelStream(bool wait) {
+    if (!modelStream.active) return;
+    auto it = pokemonModels.find(modelStream.id);
+    if (it == pokemonModels.end()) {
+        cancelModelStream();
+        return;
+    }
+    ModelData& modelData = it->second;
+    auto ready = [wait](auto& job) {
+        return wait || job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+
+    if (!modelStream.attributesUploaded && ready(modelStream.attributes)) {
+        std::vector<MeshAttributes> attributes = modelStream.attributes.get();
+        auto uploadStart = std::chrono::high_resolution_clock::now();
+        uploadModelAttributes(modelData, attributes);
+        modelLoadStats.attributesMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - uploadStart).count();
+        modelStream.attributesUploaded = true;
+    }
+
+    while (modelStream.nextTexture < modelStream.textures.size()) {
+        size_t i = modelStream.nextTexture;
+        std::future<DecodedTexture>& job = modelStream.textures[i];
+        if (!job.valid()) {
+            modelStream.nextTexture++;
+            continue;
+        }
+        if (!ready(job)) return;
+
+        DecodedTexture image = job.get();
+        GLuint texture = 0;
+        modelLoadStats.decodeMs += image.decodeMs;
+        if (image.slot < 0) releasePboSlot(modelStream.slots[i]);  // Unused (failed or too large)
+        if (image.slot >= 0 || image.pixels) {
+            texture = uploadDecodedTexture(image);
+            modelLoadStats.textureBytes += (uint64_t)image.w * image.h * 4 * 4 / 3;  // + mip chain
+            std::cout << "Loaded image: " << modelStream.texturePaths[i] << " (" << image.w << "x" << image.h << ")" << std::endl;
+        }
+        else {
+            std::cerr << "ERROR: Failed to load texture at " << modelStream.texturePaths[i] << std::endl;
+        }
+        modelData.textures.push_back(texture);
+        modelData.materialToTexture[i] = texture;
+        modelStream.nextTexture++;
+        if (!wait) return;  // Spread uploads over frames
+    }
+    if (!modelStream.attributesUploaded) return;
+
+    modelStream.active = false;
+    modelLoadStats.uploadMs = textureUploadStallMs;
+    if (useImpostors) buildImpostorAtlas(modelStream.id);
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - modelStream.start).count();
+    std::cout << "Time to full model: " << ms << " ms (" << modelData.textures.size() << " textures, "
+        << textureUploadStallMs << " ms upload stall, " << (usePboRing ? "PBO ring" : "direct") << ")" << std::endl;
+}
+
+// ===============================
+// Function: finishModelStream
+// Purpose: Completes phase two immediately; the colour reveal needs textures and texcoords.
+// ===============================
+
+void finishModelStream() {
+    pumpModelStream(true);
+}
+
+// ===============================
+// Function: cancelModelStream
+// Purpose: Abandons an unfinished phase two, waiting for its workers and freeing their pixels.
+// ===============================
+
+void cancelModelStream() {
+    if (!modelStream.active) return;
+    if (modelStream.attributes.valid()) modelStream.attributes.wait();
+    for (size_t i = 0; i < modelStream.textures.size(); i++) {
+        if (!modelStream.textures[i].valid()) continue;
+        DecodedTexture image = modelStream.textures[i].get();
+        if (image.pixels) stbi_image_free(image.pixels);
+        releasePboSlot(modelStream.slots[i]);
+    }
+    modelStream.textures.clear();
+    modelStream.active = false;
+}
+
+// ===============================
+// Function: unloadModel
+// Purpose: Releases the GPU buffers and textures of a loaded model.
+// Parameters: id - Pokémon ID (nothing happens if it is not loaded).
+// ===============================
+
+void unloadModel(int id) {
+    if (pokemonModels.find(id) == pokemonModels.end()) return;
+    if (modelStream.active && modelStream.id == id) cancelModelStream();
+    if (impostor.modelId == id) impostor.modelId = -1;
+    // Unbind everything before deletion
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    for (const auto& mesh : pokemonModels[id].meshes) {
+        glDeleteVertexArrays(1, &mesh.vao);
+        glDeleteBuffers(1, &mesh.vbo);
+        glDeleteBuffers(1, &mesh.ibo);
+        glDeleteBuffers(1, &mesh.tbo);
+        glDeleteBuffers(1, &mesh.nbo);
+    }
+    // Delete textures
+    for (GLuint texture : pokemonModels[id].textures) {
+        if (texture != 0) {
+            glDeleteTextures(1, &texture);
+        }
+    }
+    glFinish();
+    pokemonModels.erase(id);
+}
+
+// ===============================
+// Function: loadModel
+// Purpose: Loads a 3D model for a Pokémon using Assimp.
+// Parameters: id - Pokémon ID (1-151).
+// Notes: Controls model scaling, camera, and material/texture setup. Only positions are
+//        uploaded here; the rest streams in through startModelStream/pumpModelStream.
+// ===============================
+
+// Function: loadModel
 // Purpose: Loads a 3D model for a Pokémon
 // Parameters:
 //   - id: Pokémon ID (1-151)
@@ -639,165 +3324,865 @@ void loadModel(int id) {
     float modelYOffset = -0.02f;          // Vertical offset of model (world units)
     float modelBaseY = -0.05f;            // Base Y position of model (world units)
 
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    cancelModelStream();
+    modelLoadStats = ModelLoadStats();
+    if (impostor.modelId == id) impostor.modelId = -1;
+
     // Clear existing model data
-    if (pokemonModels.find(id) != pokemonModels.end()) {
-        // Unbind everything before deletion
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        for (const auto& mesh : pokemonModels[id].meshes) {
-            glDeleteVertexArrays(1, &mesh.vao);
-            glDeleteBuffers(1, &mesh.vbo);
-            glDeleteBuffers(1, &mesh.ibo);
-            glDeleteBuffers(1, &mesh.tbo);
-            glDeleteBuffers(1, &mesh.nbo);
+    unloadModel(id);
+
+    std::string basePath = modelBasePath(id);
+    std::string path = basePath + "model.obj";
+
+    std::cout << "Loading model from: " << path << std::endl;
+    std::cout << "Base path for materials: " << basePath << std::endl;
+
+    // Plan memory from the manifest before touching the model files
+    ModelData modelData;
+    const ModelManifestEntry* planned = nullptr;
+    auto manifestIt = modelManifest.find(id);
+    if (manifestIt != modelManifest.end()) {
+        planned = &manifestIt->second;
+        modelData.meshes.reserve(planned->meshCount);
+        modelData.textures.reserve(planned->materialCount);
+        modelData.materialToTexture.reserve(planned->materialCount);
+        modelData.materials.reserve(planned->materialCount);
+        std::cout << "Manifest: " << planned->vertexCount << " vertices, " << planned->indexCount
+            << " indices, ~" << planned->cpuBytes / 1024 << " KB CPU, ~"
+            << planned->gpuBytes / 1024 << " KB GPU" << std::endl;
+    }
+
+    modelData.importer = std::make_unique<Assimp::Importer>();
+    modelData.scene = modelData.importer->ReadFile(path, MODEL_IMPORT_FLAGS);
+    auto geometryStart = std::chrono::high_resolution_clock::now();
+    modelLoadStats.importMs = std::chrono::duration<double, std::milli>(geometryStart - loadStart).count();
+
+    const aiScene* scene = modelData.scene;
+    if (!scene) {
+        std::cerr << "Failed to load model: " << modelData.importer->GetErrorString() << std::endl;
+        return;
+    }
+
+    std::cout << "Loaded " << scene->mNumMeshes << " meshes and "
+        << scene->mNumMaterials << " materials" << std::endl;
+
+    // Process materials and textures
+    std::vector<std::string> texturePaths(scene->mNumMaterials);
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+        aiMaterial* material = scene->mMaterials[i];
+        texturePaths[i] = diffuseTexturePath(material, basePath);
+        if (!texturePaths[i].empty()) {
+            std::cout << "Queued texture: " << texturePaths[i] << std::endl;
+        }
+        modelData.materials.push_back(material);
+    }
+    // Filled in by pumpModelStream as the textures arrive
+    modelData.materialToTexture.assign(scene->mNumMaterials, 0);
+
+    // --- Compute bounding box for all meshes ---
+    glm::vec3 minBB(FLT_MAX), maxBB(-FLT_MAX);
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        aiMesh* mesh = scene->mMeshes[i];
+        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
+            glm::vec3 v(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+            minBB = glm::min(minBB, v);
+            maxBB = glm::max(maxBB, v);
+        }
+    }
+    glm::vec3 size = maxBB - minBB;
+    glm::vec3 center = (minBB + maxBB) * 0.5f;
+    modelH = size.y;
+    scale = containerH / modelH;
+    modelData.boundsRadius = glm::length(size) * 0.5f * scale;
+    // --- End bounding box ---
+
+    // --- Per-mesh VAO/VBO/IBO (phase one: positions only, enough for the silhouette) ---
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        aiMesh* mesh = scene->mMeshes[i];
+        MeshData meshData;
+        meshData.materialIndex = mesh->mMaterialIndex;
+        std::vector<glm::vec3> vertices;
+        std::vector<unsigned int> indices;
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(mesh->mNumFaces * 3);
+        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
+            glm::vec3 v(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+            v = (v - center) * scale;
+            vertices.emplace_back(v);
+        }
+        for (unsigned int j = 0; j < mesh->mNumFaces; ++j) {
+            aiFace face = mesh->mFaces[j];
+            for (unsigned int k = 0; k < face.mNumIndices; ++k)
+                indices.push_back(face.mIndices[k]);
+        }
+        meshData.indexCount = indices.size();
+        // VAO, VBO and IBO
+        meshData.vao = createVertexArray();
+        meshData.vbo = createStaticBuffer(vertices.size() * sizeof(glm::vec3), vertices.data());
+        attachVertexBuffer(meshData.vao, 0, meshData.vbo, 3);
+        meshData.ibo = createStaticBuffer(indices.size() * sizeof(unsigned int), indices.data());
+        attachIndexBuffer(meshData.vao, meshData.ibo);
+        modelData.meshes.push_back(meshData);
+    }
+    pokemonModels[id] = std::move(modelData);
+    modelLoadStats.geometryMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - geometryStart).count();
+    modelLoaded = true;
+    isColorReveal = false;
+    colorRevealTimer = 0.0f;
+
+    std::cout << "Time to silhouette: " << std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - loadStart).count() << " ms" << std::endl;
+
+    // Phase two: texcoords, normals and textures stream in while the player guesses
+    startModelStream(id, texturePaths, loadStart);
+
+    // Print OpenGL version and vendor
+    const GLubyte* glVersion = glGetString(GL_VERSION);
+    const GLubyte* glVendor = glGetString(GL_VENDOR);
+    std::cout << "OpenGL Version: " << (glVersion ? (const char*)glVersion : "(null)") << std::endl;
+    std::cout << "OpenGL Vendor: " << (glVendor ? (const char*)glVendor : "(null)") << std::endl;
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ===============================
+// Function: drawModelMeshes
+// Purpose: Queues every mesh of a model with the model shader variant its reveal needs.
+// Parameters: model - model matrix, reveal - 0 = silhouette, 1 = full colour.
+// ===============================
+
+void drawModelMeshes(const ModelData& modelData, const glm::mat4& model, float reveal) {
+    const ShaderProgram& shader = shaderVariant(modelShaders, modelShaderMask(reveal));
+    for (const auto& meshData : modelData.meshes) {
+        RenderPacket packet;
+        int matIndex = meshData.materialIndex;
+        // The silhouette path never samples, so it leaves the texture binding alone
+        if (reveal > 0.0f && matIndex >= 0 && matIndex < (int)modelData.materialToTexture.size()) {
+            packet.texture = modelData.materialToTexture[matIndex];
+        }
+        packet.key = renderKey(RENDER_LAYER_MODEL, 0, shader.id, packet.texture, meshData.vao);
+        packet.program = shader.id;
+        packet.shader = &shader;
+        packet.vao = meshData.vao;
+        packet.depthTest = true;
+        packet.indexed = true;
+        packet.count = (GLsizei)meshData.indexCount;
+        packet.hasModel = true;
+        packet.model = model;
+        packet.reveal = reveal;
+        renderQueue.push_back(packet);
+    }
+}
+
+// ===============================
+// Function: modelMatrixAt
+// Purpose: Returns the model matrix for the turntable at a given angle.
+// ===============================
+
+glm::mat4 modelMatrixAt(float angleDegrees) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::rotate(model, glm::radians(angleDegrees), glm::vec3(0, 1, 0));
+    // Move model slightly further down in world space
+    return glm::translate(model, glm::vec3(0, MODEL_Y_OFFSET, 0));
+}
+
+// ===============================
+// Function: buildImpostorAtlas
+// Purpose: Renders IMPOSTOR_VIEWS turntable views of a fully loaded model into one atlas.
+// Parameters: id - model to capture (its textures must be resident).
+// Notes: Each cell covers an IMPOSTOR_REGION-pixel square of the window around the model
+//        centre; the projection is cropped to that square so cells stay pixel-aligned.
+// ===============================
+
+void buildImpostorAtlas(int id) {
+    auto it = pokemonModels.find(id);
+    if (it == pokemonModels.end()) return;
+    auto start = std::chrono::high_resolution_clock::now();
+    const int atlasSize = IMPOSTOR_GRID * IMPOSTOR_CELL;
+
+    if (impostor.fbo == 0) {
+        glGenTextures(1, &impostor.color);
+        glBindTexture(GL_TEXTURE_2D, impostor.color);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenRenderbuffers(1, &impostor.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, impostor.depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glGenFramebuffers(1, &impostor.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, impostor.fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, impostor.color, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, impostor.depth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Impostor framebuffer incomplete, drawing full meshes" << std::endl;
+            useImpostors = false;
+            glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+            return;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    }
+
+    // Where the model centre lands on screen, and the crop that maps the region to a cell
+    glm::vec4 clip = cameraBlock.projection * cameraBlock.view * glm::vec4(0, MODEL_Y_OFFSET, 0, 1);
+    glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+    glm::vec2 half((float)IMPOSTOR_REGION / WIDTH, (float)IMPOSTOR_REGION / HEIGHT);
+    glm::mat4 crop = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / half.x, 1.0f / half.y, 1.0f)) *
+        glm::translate(glm::mat4(1.0f), glm::vec3(-ndc.x, -ndc.y, 0.0f));
+    glm::vec2 centre = (ndc * 0.5f + 0.5f) * glm::vec2(WIDTH, HEIGHT);
+    impostor.screenMin = centre - glm::vec2(IMPOSTOR_REGION * 0.5f);
+
+    glm::mat4 projection = cameraBlock.projection;
+    cameraBlock.projection = crop * projection;
+    cameraDirty = true;
+    updateCameraBlock();
+
+    submitRenderQueue();  // Queued draws belong to the window
+    glBindFramebuffer(GL_FRAMEBUFFER, impostor.fbo);
+    glViewport(0, 0, atlasSize, atlasSize);
+    const GLfloat clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clear);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    // Model packets draw without blending, which keeps the coverage in alpha as rendered
+    for (int view = 0; view < IMPOSTOR_VIEWS; view++) {
+        glViewport((view % IMPOSTOR_GRID) * IMPOSTOR_CELL, (view / IMPOSTOR_GRID) * IMPOSTOR_CELL,
+            IMPOSTOR_CELL, IMPOSTOR_CELL);
+        drawModelMeshes(it->second, modelMatrixAt(view * 360.0f / IMPOSTOR_VIEWS), 1.0f);
+        submitRenderQueue();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glViewport(0, 0, WIDTH, HEIGHT);
+
+    cameraBlock.projection = projection;
+    cameraDirty = true;
+    impostor.modelId = id;
+
+    std::cout << "Impostor atlas built (" << IMPOSTOR_VIEWS << " views, " << atlasSize << "x" << atlasSize
+        << ") in " << std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count() << " ms" << std::endl;
+}
+
+// ===============================
+// Function: drawImpostor
+// Purpose: Draws the captured view nearest to the current rotation as a single quad.
+// Parameters: reveal - same meaning as for the model shader.
+// ===============================
+
+void drawImpostor(float reveal) {
+    int view = (int)std::lround(rotationAngle / 360.0f * IMPOSTOR_VIEWS) % IMPOSTOR_VIEWS;
+    if (view < 0) view += IMPOSTOR_VIEWS;
+    float cell = 1.0f / IMPOSTOR_GRID;
+    glm::vec2 uv0((view % IMPOSTOR_GRID) * cell, (view / IMPOSTOR_GRID) * cell);
+    glm::vec2 uv1 = uv0 + glm::vec2(cell);
+    glm::vec2 p0 = impostor.screenMin;
+    glm::vec2 p1 = p0 + glm::vec2((float)IMPOSTOR_REGION);
+    glm::vec4 color(1.0f);
+    TextVertex quad[6] = {
+        { glm::vec2(p0.x, p1.y), glm::vec2(uv0.x, uv1.y), color },
+        { p0, uv0, color },
+        { glm::vec2(p1.x, p0.y), glm::vec2(uv1.x, uv0.y), color },
+        { glm::vec2(p0.x, p1.y), glm::vec2(uv0.x, uv1.y), color },
+        { glm::vec2(p1.x, p0.y), glm::vec2(uv1.x, uv0.y), color },
+        { p1, uv1, color },
+    };
+    glBindBuffer(GL_ARRAY_BUFFER, impostor.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(impostorProgram.id);
+    glUniform1f(impostorProgram.uniform("reveal"), reveal);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, impostor.color);
+    glBindVertexArray(impostor.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    frameDrawCalls++;
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
+
+// ===============================
+// Function: clusterIndices
+// Purpose: Simplifies a mesh by vertex clustering: vertices in the same grid cell collapse
+//          onto the first one seen and triangles that become degenerate are dropped.
+// Parameters: positions - the mesh's vertices, indices - its triangle list (mesh-local),
+//             cellSize - grid cell size in model units.
+// Returns: The simplified triangle list, referencing the same vertices.
+// ===============================
+
+std::vector<GLuint> clusterIndices(const glm::vec3* positions, const GLuint* indices, size_t indexCount,
+    float cellSize) {
+    std::unordered_map<uint64_t, GLuint> cells;
+    std::unordered_map<GLuint, GLuint> remap;
+    auto representative = [&](GLuint index) {
+        auto it = remap.find(index);
+        if (it != remap.end()) return it->second;
+        glm::vec3 p = positions[index] / cellSize;
+        uint64_t key = ((uint64_t)(int64_t)std::floor(p.x) & 0x1FFFFF) |
+            (((uint64_t)(int64_t)std::floor(p.y) & 0x1FFFFF) << 21) |
+            (((uint64_t)(int64_t)std::floor(p.z) & 0x1FFFFF) << 42);
+        GLuint rep = cells.emplace(key, index).first->second;
+        remap[index] = rep;
+        return rep;
+    };
+    std::vector<GLuint> result;
+    result.reserve(indexCount);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        GLuint a = representative(indices[i]);
+        GLuint b = representative(indices[i + 1]);
+        GLuint c = representative(indices[i + 2]);
+        if (a == b || b == c || a == c) continue;
+        result.push_back(a);
+        result.push_back(b);
+        result.push_back(c);
+    }
+    return result;
+}
+
+// ===============================
+// Function: buildGallery
+// Purpose: Loads the gallery's models and packs them into shared pools for one indirect draw.
+// Notes: Models that were not already resident are unloaded again once copied, so the
+//        gallery does not double their memory. Blocks while the models load.
+// ===============================
+
+void buildGallery() {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (galleryProgram.id == 0) {
+        galleryProgram = createShaderProgram("shaders/gallery_vertex.glsl", "shaders/gallery_fragment.glsl");
+        glUseProgram(galleryProgram.id);
+        glUniform1i(galleryProgram.uniform("textures"), 0);
+        glUniform3fv(galleryProgram.uniform("untexturedColor"), 1, &SILHOUETTE_COLOR[0]);
+        glUseProgram(0);
+    }
+    if (useGpuCulling && galleryCullProgram.id == 0) {
+        galleryCullProgram = createComputeProgram("shaders/gallery_cull.glsl");
+    }
+
+    // A random selection, laid out in Pokédex order
+    std::vector<int> ids;
+    for (int id = 1; id <= 151; id++) ids.push_back(id);
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(std::random_device{}()));
+    ids.resize(GALLERY_COLUMNS * GALLERY_ROWS);
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<int> loadedHere;
+    gallery.ids.clear();
+    for (int id : ids) {
+        if (!pokemonModels.count(id)) {
+            loadModel(id);
+            finishModelStream();
+            if (!pokemonModels.count(id)) continue;
+            loadedHere.push_back(id);
+        }
+        gallery.ids.push_back(id);
+    }
+
+    // Pool sizes and one array layer per distinct diffuse texture
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    size_t vertexCount = 0, indexCount = 0;
+    std::unordered_map<GLuint, int> textureLayers;
+    for (int id : gallery.ids) {
+        const ModelData& modelData = pokemonModels[id];
+        for (const MeshData& mesh : modelData.meshes) {
+            GLint bytes = 0;
+            glBindBuffer(GL_COPY_READ_BUFFER, mesh.vbo);
+            glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bytes);
+            vertexCount += bytes / sizeof(glm::vec3);
+            indexCount += mesh.indexCount;
         }
-        // Delete textures
-        for (GLuint texture : pokemonModels[id].textures) {
-            if (texture != 0) {
-                glDeleteTextures(1, &texture);
+        for (GLuint texture : modelData.materialToTexture) {
+            if (texture != 0 && !textureLayers.count(texture) && (GLint)textureLayers.size() < maxLayers) {
+                int layer = (int)textureLayers.size();
+                textureLayers[texture] = layer;
             }
         }
-        glFinish();
-        pokemonModels.erase(id);
     }
 
-    std::string folder = std::to_string(id);
-    folder = std::string(3 - folder.length(), '0') + folder;
-    std::string basePath = "assets/models/" + folder + "/";
-    std::string path = basePath + "model.obj";
+    // Shared pools (texcoords start zeroed for meshes that have none)
+    glGenBuffers(1, &gallery.positions);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.positions);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCount * sizeof(glm::vec3), nullptr, GL_STATIC_DRAW);
+    std::vector<glm::vec2> zeroTexCoords(vertexCount, glm::vec2(0.0f));
+    glGenBuffers(1, &gallery.texCoords);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.texCoords);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCount * sizeof(glm::vec2), zeroTexCoords.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &gallery.indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.indices);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+
+    // Copy every mesh into the pools on the GPU and record its draw and placement
+    gallery.drawList.clear();
+    gallery.instanceList.clear();
+    size_t vertexOffset = 0, indexOffset = 0;
+    for (size_t cell = 0; cell < gallery.ids.size(); cell++) {
+        const ModelData& modelData = pokemonModels[gallery.ids[cell]];
+        float x = ((int)(cell % GALLERY_COLUMNS) - (GALLERY_COLUMNS - 1) * 0.5f) * GALLERY_SPACING;
+        float y = ((GALLERY_ROWS - 1) * 0.5f - (int)(cell / GALLERY_COLUMNS)) * GALLERY_SPACING;
+        glm::mat4 placement = glm::translate(glm::mat4(1.0f), glm::vec3(x, y + MODEL_Y_OFFSET, 0.0f));
+        for (const MeshData& mesh : modelData.meshes) {
+            GLint positionBytes = 0, texCoordBytes = 0;
+            glBindBuffer(GL_COPY_READ_BUFFER, mesh.vbo);
+            glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &positionBytes);
+            size_t meshVertices = positionBytes / sizeof(glm::vec3);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.positions);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                vertexOffset * sizeof(glm::vec3), positionBytes);
+            if (mesh.tbo != 0) {
+                glBindBuffer(GL_COPY_READ_BUFFER, mesh.tbo);
+                glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &texCoordBytes);
+                if ((size_t)texCoordBytes == meshVertices * sizeof(glm::vec2)) {
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.texCoords);
+                    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                        vertexOffset * sizeof(glm::vec2), texCoordBytes);
+                }
+            }
+            glBindBuffer(GL_COPY_READ_BUFFER, mesh.ibo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.indices);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                indexOffset * sizeof(GLuint), mesh.indexCount * sizeof(GLuint));
+
+            // Models are centred on their origin, so the sphere follows the cell placement
+            GalleryDraw draw = {};
+            draw.sphere = glm::vec4(glm::vec3(placement[3]), modelData.boundsRadius);
+            draw.lodCount[0] = (GLuint)mesh.indexCount;
+            draw.lodFirst[0] = (GLuint)indexOffset;
+            draw.baseVertex = (GLint)vertexOffset;
+            draw.baseInstance = (GLuint)gallery.drawList.size();
+            gallery.drawList.push_back(draw);
+
+            GalleryInstance instance;
+            instance.model = placement;
+            instance.layer = -1.0f;
+            if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)modelData.materialToTexture.size()) {
+                auto layer = textureLayers.find(modelData.materialToTexture[mesh.materialIndex]);
+                if (layer != textureLayers.end()) instance.layer = (float)layer->second;
+            }
+            gallery.instanceList.push_back(instance);
 
-    std::cout << "Loading model from: " << path << std::endl;
-    std::cout << "Base path for materials: " << basePath << std::endl;
+            vertexOffset += meshVertices;
+            indexOffset += mesh.indexCount;
+        }
+    }
 
-    ModelData modelData;
-    modelData.importer = std::make_unique<Assimp::Importer>();
-    modelData.scene = modelData.importer->ReadFile(path,
-        aiProcess_Triangulate |
-        aiProcess_GenNormals |
-        aiProcess_CalcTangentSpace |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_SortByPType);
+    // Simplified LODs, appended to the index pool and sharing the LOD 0 vertices
+    std::vector<glm::vec3> positions(vertexCount);
+    std::vector<GLuint> indices(indexCount);
+    glBindBuffer(GL_COPY_READ_BUFFER, gallery.positions);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, positions.size() * sizeof(glm::vec3), positions.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, gallery.indices);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+    for (int lod = 1; lod < GALLERY_LODS; lod++) {
+        float cellSize = CAMERA_CONTAINER_H / GALLERY_LOD_CELLS[lod];
+        for (GalleryDraw& draw : gallery.drawList) {
+            std::vector<GLuint> simplified = clusterIndices(positions.data() + draw.baseVertex,
+                indices.data() + draw.lodFirst[0], draw.lodCount[0], cellSize);
+            draw.lodFirst[lod] = (GLuint)indices.size();
+            draw.lodCount[lod] = (GLuint)simplified.size();
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gallery.indices);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Resample every diffuse texture into its array layer
+    glGenTextures(1, &gallery.textureArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, gallery.textureArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, GALLERY_TEXTURE_SIZE, GALLERY_TEXTURE_SIZE,
+        std::max<GLsizei>(1, (GLsizei)textureLayers.size()), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLuint readFbo = 0, drawFbo = 0;
+    glGenFramebuffers(1, &readFbo);
+    glGenFramebuffers(1, &drawFbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+    for (const auto& pair : textureLayers) {
+        GLint w = 0, h = 0;
+        glBindTexture(GL_TEXTURE_2D, pair.first);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pair.first, 0);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, gallery.textureArray, 0, pair.second);
+        glBlitFramebuffer(0, 0, w, h, 0, 0, GALLERY_TEXTURE_SIZE, GALLERY_TEXTURE_SIZE,
+            GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glDeleteFramebuffers(1, &readFbo);
+    glDeleteFramebuffers(1, &drawFbo);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, gallery.textureArray);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Per-draw data, the cull input and the indirect commands it writes
+    glGenBuffers(1, &gallery.instances);
+    glBindBuffer(GL_ARRAY_BUFFER, gallery.instances);
+    glBufferData(GL_ARRAY_BUFFER, gallery.instanceList.size() * sizeof(GalleryInstance),
+        gallery.instanceList.data(), GL_STATIC_DRAW);
+    if (useMultiDrawIndirect) {
+        glGenBuffers(1, &gallery.commands);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, gallery.commands);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, gallery.drawList.size() * sizeof(DrawElementsIndirectCommand),
+            nullptr, useGpuCulling ? GL_DYNAMIC_COPY : GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    if (useGpuCulling) {
+        glGenBuffers(1, &gallery.draws);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, gallery.draws);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, gallery.drawList.size() * sizeof(GalleryDraw),
+            gallery.drawList.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glGenBuffers(1, &gallery.drawCount);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, gallery.drawCount);
+        glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+    }
 
-    const aiScene* scene = modelData.scene;
-    if (!scene) {
-        std::cerr << "Failed to load model: " << modelData.importer->GetErrorString() << std::endl;
-        return;
+    glGenVertexArrays(1, &gallery.vao);
+    glBindVertexArray(gallery.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, gallery.positions);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, gallery.texCoords);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gallery.indices);
+    // baseInstance selects each command's entry; the fallback path sets them as constants instead
+    glBindBuffer(GL_ARRAY_BUFFER, gallery.instances);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(GalleryInstance),
+            (const void*)(offsetof(GalleryInstance, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+        if (useMultiDrawIndirect) glEnableVertexAttribArray(3 + column);
     }
+    glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(GalleryInstance),
+        (const void*)offsetof(GalleryInstance, layer));
+    glVertexAttribDivisor(7, 1);
+    if (useMultiDrawIndirect) glEnableVertexAttribArray(7);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    std::cout << "Loaded " << scene->mNumMeshes << " meshes and "
-        << scene->mNumMaterials << " materials" << std::endl;
+    for (int id : loadedHere) unloadModel(id);
+    modelLoaded = pokemonModels.count(currentPokemonID) > 0;
+    gallery.built = true;
+
+    const char* path = !useMultiDrawIndirect ? "one draw per mesh, CPU culling" :
+        !useGpuCulling ? "multi-draw indirect, CPU culling" :
+        useIndirectCount ? "multi-draw indirect, compute culling" : "multi-draw indirect, compute culling in place";
+    std::cout << "Gallery built: " << gallery.ids.size() << " models, " << gallery.drawList.size()
+        << " meshes, " << vertexCount << " vertices, " << indexCount / 3 << " triangles (LOD 0), "
+        << textureLayers.size() << " texture layers in "
+        << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()
+        << " ms (" << path << ")" << std::endl;
+}
 
-    // Process materials and textures
-    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
-        aiMaterial* material = scene->mMaterials[i];
-        aiString texPath;
-        GLuint texture = 0;
-        if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS) {
-            std::string texFile = texPath.C_Str();
-            size_t lastSlash = texFile.find_last_of("/\\");
-            if (lastSlash != std::string::npos) {
-                texFile = texFile.substr(lastSlash + 1);
-            }
-            std::string fullPath = basePath + texFile;
-            std::cout << "Loading texture: " << fullPath << std::endl;
-            texture = loadTexture(fullPath.c_str());
-        }
-        modelData.textures.push_back(texture);
-        modelData.materialToTexture.push_back(texture);
-        modelData.materials.push_back(material);
+// ===============================
+// Function: destroyGallery
+// Purpose: Releases the gallery pools, texture array and command buffers.
+// ===============================
+
+void destroyGallery() {
+    if (!gallery.built) return;
+    glDeleteVertexArrays(1, &gallery.vao);
+    GLuint buffers[7] = { gallery.positions, gallery.texCoords, gallery.indices, gallery.instances,
+        gallery.commands, gallery.draws, gallery.drawCount };
+    glDeleteBuffers(7, buffers);
+    glDeleteTextures(1, &gallery.textureArray);
+    gallery = Gallery();
+}
+
+// ===============================
+// Function: enterGallery
+// Purpose: Switches to the gallery, building it on first use.
+// ===============================
+
+void enterGallery() {
+    if (!gallery.built) buildGallery();
+    if (gallery.drawList.empty()) return;
+    gallery.gameCamera = cameraBlock;
+    gallery.enterTime = std::chrono::steady_clock::now();
+    gameState = GALLERY;
+}
+
+// ===============================
+// Function: leaveGallery
+// Purpose: Returns to the start screen and restores the game camera.
+// ===============================
+
+void leaveGallery() {
+    cameraBlock = gallery.gameCamera;
+    cameraDirty = true;
+    gameState = START_SCREEN;
+}
+
+// ===============================
+// Function: extractFrustumPlanes
+// Purpose: Extracts the six frustum planes (normals pointing inwards, normalized) from a
+//          view-projection matrix.
+// ===============================
+
+void extractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6]) {
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++) rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+    for (int axis = 0; axis < 3; axis++) {
+        planes[axis * 2] = rows[3] + rows[axis];
+        planes[axis * 2 + 1] = rows[3] - rows[axis];
     }
-    std::cout << "Material to Texture mapping: ";
-    for (size_t i = 0; i < modelData.materialToTexture.size(); ++i) {
-        std::cout << "[" << i << "]=" << modelData.materialToTexture[i] << " ";
+    for (int p = 0; p < 6; p++) planes[p] /= glm::length(glm::vec3(planes[p]));
+}
+
+// ===============================
+// Function: cullGallery
+// Purpose: Culls the gallery against the camera frustum and picks each mesh's LOD.
+// Returns: Number of indirect commands for the draw (ignored when the GPU supplies the count).
+// Notes: With compute support the pass runs on the GPU and writes the indirect buffer
+//        directly; otherwise the same test runs here into gallery.visible.
+// ===============================
+
+GLsizei cullGallery() {
+    glm::vec4 planes[6];
+    extractFrustumPlanes(cameraBlock.projection * cameraBlock.view, planes);
+    glm::vec3 eye = glm::vec3(glm::inverse(cameraBlock.view)[3]);
+    float pixelsPerUnit = HEIGHT * 0.5f / tan(glm::radians(CAMERA_FOV_Y) * 0.5f);
+    GLsizei drawCount = (GLsizei)gallery.drawList.size();
+
+    if (useGpuCulling) {
+        const GLuint zero = 0;
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, gallery.drawCount);
+        glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+        glUseProgram(galleryCullProgram.id);
+        glUniform1ui(galleryCullProgram.uniform("recordCount"), (GLuint)drawCount);
+        glUniform4fv(galleryCullProgram.uniform("planes[0]"), 6, &planes[0][0]);
+        glUniform3fv(galleryCullProgram.uniform("eye"), 1, &eye[0]);
+        glUniform1f(galleryCullProgram.uniform("pixelsPerUnit"), pixelsPerUnit);
+        glUniform2fv(galleryCullProgram.uniform("lodPixels"), 1, &GALLERY_LOD_PIXELS[0]);
+        glUniform1i(galleryCullProgram.uniform("compact"), useIndirectCount ? 1 : 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gallery.draws);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, gallery.commands);
+        glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, gallery.drawCount);
+        glDispatchCompute((drawCount + 63) / 64, 1, 1);
+        // The draw reads the commands and the count as indirect parameters
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+        return drawCount;
     }
-    std::cout << std::endl;
 
-    // --- Compute bounding box for all meshes ---
-    glm::vec3 minBB(FLT_MAX), maxBB(-FLT_MAX);
-    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-        aiMesh* mesh = scene->mMeshes[i];
-        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
-            glm::vec3 v(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
-            minBB = glm::min(minBB, v);
-            maxBB = glm::max(maxBB, v);
+    gallery.visible.clear();
+    for (const GalleryDraw& draw : gallery.drawList) {
+        glm::vec3 centre(draw.sphere);
+        bool visible = true;
+        for (int p = 0; p < 6 && visible; p++) {
+            visible = glm::dot(glm::vec3(planes[p]), centre) + planes[p].w >= -draw.sphere.w;
         }
+        if (!visible) continue;
+        float pixels = 2.0f * draw.sphere.w * pixelsPerUnit / std::max(glm::length(eye - centre), 0.001f);
+        int lod = pixels < GALLERY_LOD_PIXELS.y ? 2 : (pixels < GALLERY_LOD_PIXELS.x ? 1 : 0);
+        DrawElementsIndirectCommand command = {
+            draw.lodCount[lod], 1, draw.lodFirst[lod], draw.baseVertex, draw.baseInstance
+        };
+        gallery.visible.push_back(command);
     }
-    glm::vec3 size = maxBB - minBB;
-    glm::vec3 center = (minBB + maxBB) * 0.5f;
-    modelH = size.y;
-    scale = containerH / modelH;
-    // --- End bounding box ---
+    if (useMultiDrawIndirect && !gallery.visible.empty()) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, gallery.commands);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, gallery.visible.size() * sizeof(DrawElementsIndirectCommand),
+            gallery.visible.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    return (GLsizei)gallery.visible.size();
+}
 
-    // --- Per-mesh VAO/VBO/IBO/TBO/NBO ---
-    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-        aiMesh* mesh = scene->mMeshes[i];
-        MeshData meshData;
-        meshData.materialIndex = mesh->mMaterialIndex;
-        std::vector<glm::vec3> vertices;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> texCoords;
-        std::vector<unsigned int> indices;
-        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
-            glm::vec3 v(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
-            v = (v - center) * scale;
-            vertices.emplace_back(v);
-            if (mesh->HasNormals())
-                normals.emplace_back(mesh->mNormals[j].x, mesh->mNormals[j].y, mesh->mNormals[j].z);
-            if (mesh->HasTextureCoords(0))
-                texCoords.emplace_back(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
+// ===============================
+// Function: drawGalleryScreen
+// Purpose: Draws the whole gallery grid with one indirect draw, plus its caption.
+// Notes: The camera drifts and dollies over the grid so culling and LODs come into play.
+// ===============================
+
+void drawGalleryScreen() {
+    glClearColor(0.070f, 0.133f, 0.227f, 1.0f); // dark blue, as on the start screen
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+        ProfileScope scope(PHASE_MODEL);
+        float t = std::chrono::duration<float>(std::chrono::steady_clock::now() - gallery.enterTime).count();
+        float aspect = (float)WIDTH / HEIGHT;
+        float halfWidth = GALLERY_COLUMNS * GALLERY_SPACING * 0.5f;
+        float halfHeight = GALLERY_ROWS * GALLERY_SPACING * 0.5f;
+        float framing = std::max(halfHeight, halfWidth / aspect) / tan(glm::radians(CAMERA_FOV_Y) * 0.5f);
+        glm::vec3 target(sin(t * 0.23f) * halfWidth * 0.6f, sin(t * 0.31f) * halfHeight * 0.6f, 0.0f);
+        float distance = framing * (0.725f + 0.275f * cos(t * 0.17f));  // 45% to 100% of the full view
+        setCamera(target + glm::vec3(0, 0, distance), target, aspect);
+
+        GLsizei drawCount = cullGallery();
+        glEnable(GL_DEPTH_TEST);
+        glUseProgram(galleryProgram.id);
+        updateCameraBlock();
+        glUniform1f(galleryProgram.uniform("spin"), glm::radians(rotationAngle));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, gallery.textureArray);
+        glBindVertexArray(gallery.vao);
+        if (useMultiDrawIndirect) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, gallery.commands);
+            if (useGpuCulling && useIndirectCount) {
+                glBindBuffer(GL_PARAMETER_BUFFER_ARB, gallery.drawCount);
+                glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, drawCount, 0);
+                glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+            }
+            else if (drawCount > 0) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, 0);
+            }
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            frameDrawCalls++;
         }
-        for (unsigned int j = 0; j < mesh->mNumFaces; ++j) {
-            aiFace face = mesh->mFaces[j];
-            for (unsigned int k = 0; k < face.mNumIndices; ++k)
-                indices.push_back(face.mIndices[k]);
+        else {
+            // GL 3.3 has no base instance, so the per-draw attributes become constants
+            for (const DrawElementsIndirectCommand& command : gallery.visible) {
+                const GalleryInstance& instance = gallery.instanceList[command.baseInstance];
+                for (int column = 0; column < 4; column++) glVertexAttrib4fv(3 + column, &instance.model[column][0]);
+                glVertexAttrib1f(7, instance.layer);
+                glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                    (const void*)(command.firstIndex * sizeof(GLuint)), command.baseVertex);
+                frameDrawCalls++;
+            }
         }
-        meshData.indexCount = indices.size();
-        // Create and bind VAO
-        glGenVertexArrays(1, &meshData.vao);
-        glBindVertexArray(meshData.vao);
-        // VBO
-        glGenBuffers(1, &meshData.vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, meshData.vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(0);
-        // TBO (texcoords)
-        glGenBuffers(1, &meshData.tbo);
-        glBindBuffer(GL_ARRAY_BUFFER, meshData.tbo);
-        glBufferData(GL_ARRAY_BUFFER, texCoords.size() * sizeof(glm::vec2), texCoords.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(1);
-        // NBO (normals)
-        glGenBuffers(1, &meshData.nbo);
-        glBindBuffer(GL_ARRAY_BUFFER, meshData.nbo);
-        glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), normals.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(2);
-        // IBO
-        glGenBuffers(1, &meshData.ibo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshData.ibo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
         glBindVertexArray(0);
-        modelData.meshes.push_back(meshData);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glDisable(GL_DEPTH_TEST);
     }
-    pokemonModels[id] = std::move(modelData);
-    modelLoaded = true;
-    isColorReveal = false;
-    colorRevealTimer = 0.0f;
 
-    std::cout << "Model loaded successfully with " << modelData.textures.size() << " textures" << std::endl;
+    static TextLabel captionLabel;
+    setLabelText(captionLabel, "POKEDEX GALLERY - PRESS ANY KEY", 0.6f);
+    drawLabel(captionLabel, WIDTH / 2 - captionLabel.width / 2, 30, { 1,1,1 });
+}
 
-    // Print OpenGL version and vendor
-    const GLubyte* glVersion = glGetString(GL_VERSION);
-    const GLubyte* glVendor = glGetString(GL_VENDOR);
-    std::cout << "OpenGL Version: " << (glVersion ? (const char*)glVersion : "(null)") << std::endl;
-    std::cout << "OpenGL Vendor: " << (glVendor ? (const char*)glVendor : "(null)") << std::endl;
+// ===============================
+// Function: initDynamicResolution
+// Purpose: Creates the offscreen model target (window-sized; only the scaled corner is used).
+// ===============================
+
+void initDynamicResolution() {
+    DynamicResolution& dr = dynamicResolution;
+    glGenTextures(1, &dr.color);
+    glBindTexture(GL_TEXTURE_2D, dr.color);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);  // Bilinear upscale
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenRenderbuffers(1, &dr.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, dr.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &dr.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, dr.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dr.color, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, dr.depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Dynamic resolution framebuffer incomplete, rendering the model at full size" << std::endl;
+        useDynamicResolution = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    createScreenQuadArray(dr.vao, dr.vbo);
+}
+
+// ===============================
+// Function: drawModelScaled
+// Purpose: Renders the model at the current dynamic resolution scale and composites the
+//          bilinearly upscaled result over the window.
+// Parameters: same as drawModelMeshes.
+// Notes: Runs inside the model profiler phase, whose GPU time drives the controller.
+// ===============================
 
+void drawModelScaled(const ModelData& modelData, const glm::mat4& model, float reveal) {
+    DynamicResolution& dr = dynamicResolution;
+    int w = (int)std::lround(WIDTH * dr.scale);
+    int h = (int)std::lround(HEIGHT * dr.scale);
+
+    submitRenderQueue();  // Anything still queued belongs to the window (drawGameScreen submits first)
+    glBindFramebuffer(GL_FRAMEBUFFER, dr.fbo);
+    glViewport(0, 0, w, h);
+    glEnable(GL_SCISSOR_TEST);  // Only clear the part that is used
+    glScissor(0, 0, w, h);
+    const GLfloat clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clear);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+    drawModelMeshes(modelData, model, reveal);
+    submitRenderQueue();
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glViewport(0, 0, WIDTH, HEIGHT);
+
+    // The quad samples only the rendered corner of the target
+    if (dr.quadScale != dr.scale) {
+        float u = (float)w / WIDTH, v = (float)h / HEIGHT;
+        glm::vec4 color(1.0f);
+        TextVertex quad[6] = {
+            { glm::vec2(0.0f, HEIGHT), glm::vec2(0.0f, v), color },
+            { glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), color },
+            { glm::vec2(WIDTH, 0.0f), glm::vec2(u, 0.0f), color },
+            { glm::vec2(0.0f, HEIGHT), glm::vec2(0.0f, v), color },
+            { glm::vec2(WIDTH, 0.0f), glm::vec2(u, 0.0f), color },
+            { glm::vec2(WIDTH, HEIGHT), glm::vec2(u, v), color },
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, dr.vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dr.quadScale = dr.scale;
+    }
+    // The target was cleared to transparent black, so filtered edges are premultiplied
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(spriteProgram.id);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, dr.color);
+    glBindVertexArray(dr.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    frameDrawCalls++;
     glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// ===============================
+// Function: updateDynamicResolution
+// Purpose: Adjusts the model pass scale from the last measured model GPU time.
+// Notes: Fill cost follows the pixel count, so the scale moves by the square root of the
+//        budget ratio. Shrinking happens as soon as the smoothed time is over budget,
+//        growing one step at a time and only with 20% headroom, to avoid oscillation.
+// ===============================
+
+void updateDynamicResolution() {
+    if (!useDynamicResolution || profiler.historyCount == 0) return;
+    DynamicResolution& dr = dynamicResolution;
+    int slot = (profiler.historyNext + PROFILE_HISTORY - 1) % PROFILE_HISTORY;
+    float gpuMs = profiler.gpuHistory[PHASE_MODEL][slot];
+    if (gpuMs <= 0.0f) return;  // No model drawn, or the result is not back yet
+    dr.smoothedMs = dr.smoothedMs < 0.0 ? gpuMs : dr.smoothedMs * 0.8 + gpuMs * 0.2;
+    if (++dr.framesSinceChange < DYNRES_INTERVAL) return;
+    dr.framesSinceChange = 0;
+
+    float scale = dr.scale;
+    if (dr.smoothedMs > gpuBudgetMs) {
+        scale = std::floor(dr.scale * (float)std::sqrt(gpuBudgetMs / dr.smoothedMs) / DYNRES_STEP) * DYNRES_STEP;
+    }
+    else if (dr.smoothedMs < gpuBudgetMs * 0.8) {
+        scale = dr.scale + DYNRES_STEP;
+    }
+    scale = std::min(DYNRES_MAX_SCALE, std::max(DYNRES_MIN_SCALE, scale));
+    if (std::fabs(scale - dr.scale) > 0.001f) {
+        dr.scale = scale;
+        dr.smoothedMs = -1.0;  // Measure the new size afresh
+    }
 }
 
 // ===============================
@@ -829,106 +4214,74 @@ void drawGameScreen() {
     // Top right: Score and Timer
     std::string scoreStr = "SCORE: " + std::to_string(score);
     std::string timeStr = "TIME: " + std::to_string(remainingTime);
-    float scoreWidth = scoreStr.length() * 32 * scoreScale * 0.6f;
-    float timeWidth = timeStr.length() * 32 * timeScale * 0.6f;
+    static TextLabel scoreLabel;
+    setLabelText(scoreLabel, scoreStr, scoreScale);
+    float scoreWidth = scoreLabel.width;
+    static TextLabel timeLabel;
+    setLabelText(timeLabel, timeStr, timeScale);
+    float timeWidth = timeLabel.width;
     float scoreX = WIDTH - scoreWidth - 40;    // X position of score (pixels)
     float scoreY = HEIGHT - 60;                // Y position of score (pixels)
     float timeX = WIDTH - timeWidth - 40;      // X position of timer (pixels)
     float timeY = HEIGHT - 110;                // Y position of timer (pixels)
 
-    // Clear the screen and set up 2D rendering for background
+    // Clear the screen
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Draw game background
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, gameBg.id);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
-    glTexCoord2f(1.0f, 0.0f); glVertex2f(WIDTH, 0.0f);
-    glTexCoord2f(1.0f, 1.0f); glVertex2f(WIDTH, HEIGHT);
-    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, HEIGHT);
-    glEnd();
-    glDisable(GL_TEXTURE_2D);
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-
-    // 3D model rendering
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(45.0, (double)WIDTH / HEIGHT, 0.1f, 100.0f);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    float containerH = 0.5f;
-    float fovY = 45.0f;
-    float fovY_rad = glm::radians(fovY);
-    float camDist = (containerH * 0.5f) / tan(fovY_rad * 0.5f);
-    camDist *= 2.0f;
-    // Move model base slightly further down (closer to center)
-    gluLookAt(0, -0.05, camDist, 0, -0.05, 0, 0, 1, 0);
-    glEnable(GL_DEPTH_TEST);
+    // Static layer: background, player name and the 'GUESS:' prompt, rebuilt only when
+    // the player changes. Drawn first since the model goes on top of it.
+    float centerY = guessBoxY + guessBoxHeight / 2;
+    static TextLabel playerLabel;
+    static TextLabel guessPromptLabel;
+    drawCachedLayer(gameLayer, playerName, [&]() {
+        drawSprite(gameBg.id, 0.0f, 0.0f, WIDTH, HEIGHT);
+        // Top left: Player name
+        setLabelText(playerLabel, "PLAYER: " + playerName, 0.7f);
+        drawLabel(playerLabel, playerInfoX, playerInfoY, { 1,1,1 });
+        // 'GUESS:' left-aligned in rectangle, vertically centered
+        setLabelText(guessPromptLabel, "GUESS:", guessLabelScale);
+        float guessLabelX = guessBoxX + 20;
+        float guessLabelY = centerY + 10;
+        drawLabel(guessPromptLabel, guessLabelX, guessLabelY, { 1,1,1 }); // Always white
+        });
+
+    // 3D model rendering (view/projection come from the camera uniform block)
     glClearDepth(1.0f);
     if (modelLoaded && pokemonModels.count(currentPokemonID)) {
+        // Draw what is already queued (background, labels) first: that fixed fill cost must
+        // not count as model GPU time, which dynamic resolution scales against
+        submitRenderQueue();
+        ProfileScope scope(PHASE_MODEL);
         const ModelData& modelData = pokemonModels[currentPokemonID];
-        glUseProgram(shaderProgram);
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::rotate(model, glm::radians(rotationAngle), glm::vec3(0, 1, 0));
-        // Move model slightly further down in world space
-        model = glm::translate(model, glm::vec3(0, -0.02f, 0));
-        glm::mat4 view = glm::lookAt(glm::vec3(0, -0.05, camDist), glm::vec3(0, -0.05, 0), glm::vec3(0, 1, 0));
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / HEIGHT, 0.1f, 100.0f);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
-        for (const auto& meshData : modelData.meshes) {
-            int matIndex = meshData.materialIndex;
-            if (matIndex >= 0 && matIndex < modelData.materialToTexture.size()) {
-                GLuint tex = modelData.materialToTexture[matIndex];
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, tex);
-                glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-            }
-            glBindVertexArray(meshData.vao);
-            glDrawElements(GL_TRIANGLES, meshData.indexCount, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
+        // Silhouette until the guess is right, then fade to the textured colours
+        float reveal = 1.0f;
+        if (isColorReveal) reveal = std::min(colorRevealTimer / COLOR_REVEAL_TIME, 1.0f);
+        else if (isSilhouette) reveal = 0.0f;
+        if (useImpostors && impostor.modelId == currentPokemonID) {
+            drawImpostor(reveal);
+        }
+        else if (useDynamicResolution) {
+            updateCameraBlock();
+            drawModelScaled(modelData, modelMatrixAt(rotationAngle), reveal);
+        }
+        else {
+            updateCameraBlock();
+            drawModelMeshes(modelData, modelMatrixAt(rotationAngle), reveal);
+            submitRenderQueue();
         }
-        glUseProgram(0);
     }
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_LIGHTING);
-    // 2D UI overlay
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    // Top left: Player name
-    renderText("PLAYER: " + playerName, playerInfoX, playerInfoY, 0.7f, { 1,1,1 });
+    // 2D UI overlay (dynamic text only)
     // Top right: Score and Timer
-    renderText(scoreStr, scoreX, scoreY, scoreScale, { 1,1,1 });
-    renderText(timeStr, timeX, timeY, timeScale, { 1,1,1 });
-    // 'GUESS:' left-aligned in rectangle, vertically centered
-    std::string guessLabel = "GUESS:";
-    float guessLabelX = guessBoxX + 20;
-    float fontPixelHeight = characters['A'].size.y * guessLabelScale;
-    float centerY = guessBoxY + guessBoxHeight / 2;
-    float guessLabelY = centerY + 10;
-    renderText(guessLabel, guessLabelX, guessLabelY, guessLabelScale, { 1,1,1 }); // Always white
+    drawLabel(scoreLabel, scoreX, scoreY, { 1,1,1 });
+    drawLabel(timeLabel, timeX, timeY, { 1,1,1 });
     // User's guess centered in rectangle (not window), vertically centered
     std::string guessMsg = currentGuess;
-    float guessWidth = guessMsg.length() * 32 * guessScale * 0.6f;
+    static TextLabel guessLabel;
+    setLabelText(guessLabel, guessMsg, guessScale);
+    float guessWidth = guessLabel.width;
     float guessCenterX = guessBoxX + guessBoxWidth / 2 - guessWidth / 2;
     float guessCenterY = centerY + 10;
-    renderText(guessMsg, guessCenterX, guessCenterY, guessScale, { 1,1,1 }); // Always white
+    drawLabel(guessLabel, guessCenterX, guessCenterY, { 1,1,1 }); // Always white
 }
 
 // ===============================
@@ -939,33 +4292,30 @@ void drawGameScreen() {
 void drawGameOverScreen() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
     std::string overMsg = "GAME OVER";
     float overScale = 2.0f; // larger
-    float overWidth = overMsg.length() * 32 * overScale * 0.6f;
-    renderText(overMsg, WIDTH / 2 - overWidth / 2, HEIGHT / 2 + 200, overScale, { 1,1,1 }); // much higher
+    static TextLabel overMsgLabel;
+    setLabelText(overMsgLabel, overMsg, overScale);
+    float overWidth = overMsgLabel.width;
+    drawLabel(overMsgLabel, WIDTH / 2 - overWidth / 2, HEIGHT / 2 + 200, { 1,1,1 }); // much higher
     std::string finalScore = playerName + ",S FINAL SCORE: " + std::to_string(score);
     float scoreScale = 1.0f;
-    float scoreWidth = finalScore.length() * 32 * scoreScale * 0.6f;
-    renderText(finalScore, WIDTH / 2 - scoreWidth / 2, HEIGHT / 2 + 10, scoreScale, { 1,1,1 });
+    static TextLabel finalScoreLabel;
+    setLabelText(finalScoreLabel, finalScore, scoreScale);
+    float scoreWidth = finalScoreLabel.width;
+    drawLabel(finalScoreLabel, WIDTH / 2 - scoreWidth / 2, HEIGHT / 2 + 10, { 1,1,1 });
     std::string restartMsg = "PRESS R TO RESTART";
     float restartScale = 0.7f;
-    float restartWidth = restartMsg.length() * 32 * restartScale * 0.6f;
-    renderText(restartMsg, WIDTH / 2 - restartWidth / 2, HEIGHT / 2 - 60, restartScale, { 1,1,1 });
+    static TextLabel restartMsgLabel;
+    setLabelText(restartMsgLabel, restartMsg, restartScale);
+    float restartWidth = restartMsgLabel.width;
+    drawLabel(restartMsgLabel, WIDTH / 2 - restartWidth / 2, HEIGHT / 2 - 60, { 1,1,1 });
     std::string quitMsg = "PRESS Q TO QUIT";
     float quitScale = 0.7f;
-    float quitWidth = quitMsg.length() * 32 * quitScale * 0.6f;
-    renderText(quitMsg, WIDTH / 2 - quitWidth / 2, HEIGHT / 2 - 110, quitScale, { 1,1,1 });
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    static TextLabel quitMsgLabel;
+    setLabelText(quitMsgLabel, quitMsg, quitScale);
+    float quitWidth = quitMsgLabel.width;
+    drawLabel(quitMsgLabel, WIDTH / 2 - quitWidth / 2, HEIGHT / 2 - 110, { 1,1,1 });
 }
 
 // ===============================
@@ -977,33 +4327,30 @@ void drawWinScreen() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     // Set orange background
     glClearColor(1.0f, 0.65f, 0.0f, 1.0f);  // Changed from yellow to orange
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
     std::string congrats = "CONGRATULATIONS " + playerName + "' YOU,RE A POKEMON MASTER!";
     float congratsScale = 1.0f;
-    float congratsWidth = congrats.length() * 32 * congratsScale * 0.6f;
-    renderText(congrats, WIDTH / 2 - congratsWidth / 2, HEIGHT / 2 + 40, congratsScale, { 1,1,1 });
+    static TextLabel congratsLabel;
+    setLabelText(congratsLabel, congrats, congratsScale);
+    float congratsWidth = congratsLabel.width;
+    drawLabel(congratsLabel, WIDTH / 2 - congratsWidth / 2, HEIGHT / 2 + 40, { 1,1,1 });
     std::string complete = "GAME COMPLETE";
     float completeScale = 1.2f;
-    float completeWidth = complete.length() * 32 * completeScale * 0.6f;
-    renderText(complete, WIDTH / 2 - completeWidth / 2, HEIGHT / 2 - 40, completeScale, { 1,1,1 });
+    static TextLabel completeLabel;
+    setLabelText(completeLabel, complete, completeScale);
+    float completeWidth = completeLabel.width;
+    drawLabel(completeLabel, WIDTH / 2 - completeWidth / 2, HEIGHT / 2 - 40, { 1,1,1 });
     std::string restartMsg = "PRESS R TO RESTART";
     float restartScale = 0.7f;
-    float restartWidth = restartMsg.length() * 32 * restartScale * 0.6f;
-    renderText(restartMsg, WIDTH / 2 - restartWidth / 2, HEIGHT / 2 - 120, restartScale, { 1,1,1 });
+    static TextLabel restartMsgLabel;
+    setLabelText(restartMsgLabel, restartMsg, restartScale);
+    float restartWidth = restartMsgLabel.width;
+    drawLabel(restartMsgLabel, WIDTH / 2 - restartWidth / 2, HEIGHT / 2 - 120, { 1,1,1 });
     std::string quitMsg = "PRESS Q TO QUIT";
     float quitScale = 0.7f;
-    float quitWidth = quitMsg.length() * 32 * quitScale * 0.6f;
-    renderText(quitMsg, WIDTH / 2 - quitWidth / 2, HEIGHT / 2 - 170, quitScale, { 1,1,1 });
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    static TextLabel quitMsgLabel;
+    setLabelText(quitMsgLabel, quitMsg, quitScale);
+    float quitWidth = quitMsgLabel.width;
+    drawLabel(quitMsgLabel, WIDTH / 2 - quitWidth / 2, HEIGHT / 2 - 170, { 1,1,1 });
 }
 
 // ===============================
@@ -1046,9 +4393,11 @@ void checkGuess() {
             return;
         }
 
-        // Start color reveal animation
+        // Start color reveal animation (textures must be resident first)
+        finishModelStream();
         isColorReveal = true;
         colorRevealTimer = 0.0f;
+        revealStartTime = GameClock::now();
         currentGuess.clear();
 
         // Pause game BGM and play success sound
@@ -1076,6 +4425,12 @@ void keyboard(unsigned char key, int x, int y) {
             gameState = NAME_ENTRY;
             playerName.clear();
         }
+        else if (key == 'g' || key == 'G') {
+            enterGallery();
+        }
+        break;
+    case GALLERY:
+        leaveGallery();
         break;
     case NAME_ENTRY:
         if (key == 13) {
@@ -1085,11 +4440,11 @@ void keyboard(unsigned char key, int x, int y) {
                 initializePokemonSequence();
                 currentPokemonID = getNextPokemonID();
                 score = 0;
-                remainingTime = TIMER_LIMIT;
                 isSilhouette = true;
                 isColorReveal = false;
                 colorRevealTimer = 0.0f;
                 loadModel(currentPokemonID);
+                startRoundTimer();
                 alSourceStop(bgmSource);
                 alSourcePlay(gameBgmSource);
             }
@@ -1130,6 +4485,7 @@ void keyboard(unsigned char key, int x, int y) {
             alSourcePlay(bgmSource);
         }
         else if (key == 'q' || key == 'Q') {
+            shutdownFrameCapture();  // Drain pending readbacks while the context is still current
             exit(0);
         }
         break;
@@ -1151,6 +4507,7 @@ void keyboard(unsigned char key, int x, int y) {
         }
         else if (key == 'q' || key == 'Q') {
             alSourceStop(winnerBgmSource);
+            shutdownFrameCapture();
             exit(0);
         }
         break;
@@ -1158,6 +4515,16 @@ void keyboard(unsigned char key, int x, int y) {
     glutPostRedisplay();
 }
 
+// ===============================
+// Function: startRoundTimer
+// Purpose: Starts the TIMER_LIMIT countdown for a new guess from the current time.
+// ===============================
+
+void startRoundTimer() {
+    roundDeadline = GameClock::now() + std::chrono::seconds(TIMER_LIMIT);
+    remainingTime = TIMER_LIMIT;
+}
+
 // ===============================
 // Function: update
 // Purpose: Main game update loop, handles animations, timing, and model rotation.
@@ -1170,18 +4537,20 @@ void keyboard(unsigned char key, int x, int y) {
 // Note: Can be modified to change game speed and animations
 void update(int value) {
     // ===== ANIMATION AND TIMING CONTROL =====
-    // Modify these values to change animation speeds and timing
+    // Speeds are per second (see ROTATION_SPEED, FLASH_SPEED, COLOR_REVEAL_TIME, TIMER_LIMIT)
+    ProfileScope scope(PHASE_UPDATE);
+    GameClock::time_point frameStart = GameClock::now();
+    frameDelta = std::min(std::chrono::duration<float>(frameStart - lastUpdateTime).count(), MAX_FRAME_DELTA);
+    lastUpdateTime = frameStart;
 
     // Model rotation
-    float rotationSpeed = 1.0f;           // Degrees per frame
-    rotationAngle += rotationSpeed;
-    if (rotationAngle > 360) rotationAngle -= 360;
+    rotationAngle = std::fmod(rotationAngle + ROTATION_SPEED * frameDelta, 360.0f);
 
     // Game timing
     if (gameState == PLAYING) {
+        pumpModelStream(false);
         if (isColorReveal) {
-            float revealSpeed = 0.016f;    // Color reveal animation speed
-            colorRevealTimer += revealSpeed;
+            colorRevealTimer = std::chrono::duration<float>(frameStart - revealStartTime).count();
 
             if (colorRevealTimer >= COLOR_REVEAL_TIME) {
                 isColorReveal = false;
@@ -1189,43 +4558,44 @@ void update(int value) {
                 currentPokemonID = getNextPokemonID();
 
                 // Check if all Pokémon have been caught
+                // (the loop keeps running on the win screen, so no early return)
                 if (score == 151) {
                     gameState = WIN_SCREEN;
                     alSourceStop(gameBgmSource);
-                    glutPostRedisplay();
-                    return;
                 }
+                else {
+                    loadModel(currentPokemonID);
+                    startRoundTimer();  // Loading time does not count against the player
 
-                remainingTime = TIMER_LIMIT;
-                loadModel(currentPokemonID);
-
-                // Resume game BGM
-                alSourcePlay(gameBgmSource);
+                    // Resume game BGM
+                    alSourcePlay(gameBgmSource);
+                }
             }
         }
         else {
-            // Timer update
-            static float timeAccumulator = 0.0f;
-            float timeStep = 0.016f;       // Timer update speed
-            timeAccumulator += timeStep;
-
-            if (timeAccumulator >= 1.0f) {
-                remainingTime--;
-                timeAccumulator = 0.0f;
-
-                // Game over check
-                if (remainingTime <= 0) {
-                    gameState = GAME_OVER;
-                    alSourceStop(gameBgmSource);
-                    playSound(gameOverSource);
-                }
+            // Timer update: whole seconds left until the deadline
+            float secondsLeft = std::chrono::duration<float>(roundDeadline - frameStart).count();
+            remainingTime = std::max(0, (int)std::ceil(secondsLeft));
+
+            // Game over check
+            if (secondsLeft <= 0.0f) {
+                gameState = GAME_OVER;
+                alSourceStop(gameBgmSource);
+                playSound(gameOverSource);
             }
         }
     }
 
-    // Update display and set next frame
+    // Update display and schedule the next frame at the start of the next frame slot,
+    // so time spent in this update and in loading does not push the rate below target
     glutPostRedisplay();
-    glutTimerFunc(16, update, 0);         // 60 FPS (1000ms/60 ≈ 16ms)
+    int delayMs = 0;
+    if (targetFps > 0) {
+        GameClock::time_point next = frameStart + std::chrono::microseconds(1000000 / targetFps);
+        delayMs = (int)std::max<long long>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(next - GameClock::now()).count());
+    }
+    glutTimerFunc(delayMs, update, 0);
 }
 
 // ===============================
@@ -1237,6 +4607,9 @@ void update(int value) {
 // Purpose: Cleans up OpenGL and OpenAL resources
 // Note: Called on program exit
 void cleanup() {
+    // Stop streaming workers before the scenes they read are released
+    cancelModelStream();
+
     // Delete OpenGL resources
     for (auto& pair : pokemonModels) {
         for (const auto& mesh : pair.second.meshes) {
@@ -1254,10 +4627,25 @@ void cleanup() {
         }
         glFinish();
     }
+    destroyGallery();
+    shutdownFrameCapture();
+    destroyPboRing();
+    if (fontFace) FT_Done_Face(fontFace);
+    if (fontLibrary) FT_Done_FreeType(fontLibrary);
+
     // Do NOT delete textures in the pool (pool workaround)
     // glDeleteTextures(TEXTURE_POOL_SIZE, texturePool);
 
-    // Cleanup OpenAL
+#ifdef POK3DEX_HEADLESS_EGL
+    if (headlessContext != EGL_NO_CONTEXT) {
+        eglMakeCurrent(headlessDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(headlessDisplay, headlessContext);
+        eglTerminate(headlessDisplay);
+    }
+#endif
+
+    // Cleanup OpenAL (never opened in headless runs)
+    if (!alDevice) return;
     alDeleteSources(1, &bgmSource);
     alDeleteSources(1, &successSource);
     alDeleteSources(1, &failureSource);
@@ -1283,22 +4671,13 @@ void playSound(ALuint source) {
 
 // ===============================
 // Function: drawInputBox
-// Purpose: (Legacy) Draws a GLUT-based input box for guesses (not used in main UI).
+// Purpose: (Legacy) Draws a simple input box for guesses (not used in main UI).
 // ===============================
 
 void drawInputBox() {
-    // GLUT-based input box
-    glColor3f(0.2f, 0.2f, 0.2f);
-    glBegin(GL_QUADS);
-    glVertex2f(50, HEIGHT - 200);  // Fix position
-    glVertex2f(WIDTH - 50, HEIGHT - 200);
-    glVertex2f(WIDTH - 50, HEIGHT - 100);
-    glVertex2f(50, HEIGHT - 100);
-    glEnd();
-
-    glColor3f(1, 1, 1);
-    glRasterPos2f(70, HEIGHT - 150); // Fix text position
-    glutBitmapString(GLUT_BITMAP_HELVETICA_18, (const unsigned char*)("GUESS: " + currentGuess).c_str());
+    // Solid grey box behind the guess
+    drawSprite(0, 50, HEIGHT - 200, WIDTH - 100, 100, glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+    renderText("GUESS: " + currentGuess, 70, HEIGHT - 150, 0.4f, { 1,1,1 });
 }
 
 // ===============================
@@ -1308,9 +4687,6 @@ void drawInputBox() {
 // ===============================
 
 void drawStartScreen() {
-    glUseProgram(0);
-    glDisable(GL_LIGHTING);
-    glEnable(GL_TEXTURE_2D);
     glDisable(GL_DEPTH_TEST); // Disable depth test for 2D UI
 
     // Set a known clear color (same as background)
@@ -1318,37 +4694,18 @@ void drawStartScreen() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Debug: Print font status
-    if (characters.empty() || characters.find('A') == characters.end()) {
+    if (!fontLoaded) {
         std::cerr << "[drawStartScreen] Font NOT loaded or missing 'A' character!" << std::endl;
         return;
     }
 
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    // Draw background
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, startBg.id);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
-    glTexCoord2f(1.0f, 0.0f); glVertex2f(WIDTH, 0.0f);
-    glTexCoord2f(1.0f, 1.0f); glVertex2f(WIDTH, HEIGHT);
-    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, HEIGHT);
-    glEnd();
-    glDisable(GL_TEXTURE_2D);
-
-    // --- Ensure OpenGL state for text rendering ---
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Draw background (cached; only the flashing text changes per frame)
+    drawCachedLayer(startLayer, "", []() {
+        drawSprite(startBg.id, 0.0f, 0.0f, WIDTH, HEIGHT);
+        });
 
     // Always use flashing logic
-    flashAlpha += flashDir ? FLASH_SPEED * 3.0f : -FLASH_SPEED * 3.0f;
+    flashAlpha += (flashDir ? FLASH_SPEED * 3.0f : -FLASH_SPEED * 3.0f) * frameDelta;
     if (flashAlpha >= 1.0f) {
         flashAlpha = 1.0f;
         flashDir = false;
@@ -1359,23 +4716,16 @@ void drawStartScreen() {
     }
     float textAlpha = flashAlpha;
 
-    glColor4f(1.0f, 1.0f, 1.0f, textAlpha); // Set color and alpha explicitly
-
     // Draw the text
     float textScale = 1.1f;
     std::string msg = "PRESS ENTER TO START";
-    float textWidth = msg.length() * 32 * textScale * 0.6f;
+    static TextLabel msgLabel;
+    setLabelText(msgLabel, msg, textScale);
+    float textWidth = msgLabel.width;
     float textX = WIDTH / 2 - textWidth / 2;
     float textY = 60; // 60px above the bottom
 
-    renderText(msg, textX, textY, textScale, { 1,1,1 });
-
-    glDisable(GL_BLEND);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    drawLabel(msgLabel, textX, textY, { 1,1,1 }, textAlpha);
 }
 
 // ===============================
@@ -1388,52 +4738,304 @@ void drawNameEntryScreen() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     // Set sky blue background
     glClearColor(0.529f, 0.808f, 0.922f, 1.0f);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    // Enable blending for text
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Draw prompt with full opacity
     std::string prompt = "ENTER YOUR NAME";
     float promptScale = 1.2f;
-    float promptWidth = prompt.length() * 32 * promptScale * 0.6f;
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);  // Full white with full opacity
-    renderText(prompt, WIDTH / 2 - promptWidth / 2, HEIGHT / 2 + 120, promptScale, { 1,1,1 });
+    static TextLabel promptLabel;
+    setLabelText(promptLabel, prompt, promptScale);
+    float promptWidth = promptLabel.width;
+    drawLabel(promptLabel, WIDTH / 2 - promptWidth / 2, HEIGHT / 2 + 120, { 1,1,1 });
 
     // Name entry text with full opacity
     std::string nameDisplay = playerName;
     float nameScale = 0.8f;
-    float nameWidth = nameDisplay.length() * 32 * nameScale * 0.6f;
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);  // Full white with full opacity
-    renderText(nameDisplay, WIDTH / 2 - nameWidth / 2, HEIGHT / 2, nameScale, { 1,1,1 });
+    static TextLabel nameDisplayLabel;
+    setLabelText(nameDisplayLabel, nameDisplay, nameScale);
+    float nameWidth = nameDisplayLabel.width;
+    drawLabel(nameDisplayLabel, WIDTH / 2 - nameWidth / 2, HEIGHT / 2, { 1,1,1 });
 
     // Add instruction for gender guesses
     std::string genderMsg = "ADD <SPACE>M OR <SPACE>F TO POKEMON NAME FOR MALE AND FEMALE GUESSES WHEN NEEDED";
     float genderScale = 0.6f;
-    float genderWidth = genderMsg.length() * 32 * genderScale * 0.6f;
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-    renderText(genderMsg, WIDTH / 2 - genderWidth / 2, HEIGHT / 2 - 80, genderScale, { 1,1,1 });
+    static TextLabel genderMsgLabel;
+    setLabelText(genderMsgLabel, genderMsg, genderScale);
+    float genderWidth = genderMsgLabel.width;
+    drawLabel(genderMsgLabel, WIDTH / 2 - genderWidth / 2, HEIGHT / 2 - 80, { 1,1,1 });
 
     // Continue message with full opacity
     std::string continueMsg = "PRESS ENTER TO CONTINUE";
     float continueScale = 0.7f;
-    float continueWidth = continueMsg.length() * 32 * continueScale * 0.6f;
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);  // Full white with full opacity
-    renderText(continueMsg, WIDTH / 2 - continueWidth / 2, HEIGHT / 2 - 120, continueScale, { 1,1,1 });
+    static TextLabel continueMsgLabel;
+    setLabelText(continueMsgLabel, continueMsg, continueScale);
+    float continueWidth = continueMsgLabel.width;
+    drawLabel(continueMsgLabel, WIDTH / 2 - continueWidth / 2, HEIGHT / 2 - 120, { 1,1,1 });
+}
 
-    glDisable(GL_BLEND);
+// ===============================
+// Function: display
+// Purpose: Draws and presents one frame of the current screen (GLUT display callback,
+//          also called directly by the headless benchmark).
+// ===============================
+
+void display() {
+    frameDrawCalls = 0;
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    switch (gameState) {
+    case START_SCREEN: drawStartScreen(); break;
+    case NAME_ENTRY: drawNameEntryScreen(); break;
+    case PLAYING: drawGameScreen(); break;
+    case GAME_OVER: drawGameOverScreen(); break;
+    case WIN_SCREEN: drawWinScreen(); break;
+    case GALLERY: drawGalleryScreen(); break;
+    }
+    drawProfilerOverlay();
+    // Sprites queued by the screen above, then all UI text in one draw. Each phase submits
+    // its own packets so its GPU timer covers its draws (layers and the model do the same).
+    {
+        ProfileScope scope(PHASE_SPRITES);
+        flushSprites();
+        submitRenderQueue();
+    }
+    {
+        ProfileScope scope(PHASE_TEXT);
+        flushText();
+        submitRenderQueue();
+    }
+    {
+        ProfileScope scope(PHASE_SUBMIT);
+        submitRenderQueue();  // Anything a screen queued outside the phases above
+    }
+    captureFrame();
+    endTextFrame();
+    {
+        ProfileScope scope(PHASE_SWAP);
+        // Headless frames have no swap; finishing the GPU work keeps frame times honest
+        if (headlessMode) glFinish();
+        else glutSwapBuffers();
+    }
+    endProfilerFrame();
+    updateDynamicResolution();
+    collectCaptures();
+    if (showFrameStats) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (frameStatsCount > 0) {  // The first frame has no previous one to measure from
+            frameStatsMs += std::chrono::duration<double, std::milli>(now - lastFrameTime).count();
+        }
+        lastFrameTime = now;
+        if (++frameStatsCount > 300) {
+            std::cout << "Frame: " << frameStatsMs / 300 << " ms avg"
+                << (useImpostors ? " (impostors)" : "") << std::endl;
+            if (useDynamicResolution) {
+                std::cout << "Model pass scale: " << dynamicResolution.scale * 100.0f << "% (budget "
+                    << gpuBudgetMs << " ms)" << std::endl;
+            }
+            std::cout << "State changes/frame: " << renderQueueStats.naive / 300.0 << " unfiltered, "
+                << renderQueueStats.inOrder / 300.0 << " filtered in order, " << renderQueueStats.issued / 300.0
+                << " sorted (" << renderQueueStats.packets / 300.0 << " packets)" << std::endl;
+            renderQueueStats = RenderQueueStats();
+            frameStatsMs = 0.0;
+            frameStatsCount = 1;
+        }
+    }
+    if (!firstFramePresented) {
+        firstFramePresented = true;
+        std::cout << "Time to first frame: " << std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - appStartTime).count() << " ms" << std::endl;
+    }
+}
+
+// ===============================
+// Function: createHeadlessContext
+// Purpose: Creates a windowless OpenGL 3.3 core context for --headless runs.
+// Returns: false if the build or the host cannot provide one.
+// Notes: Uses an EGL surfaceless display (Mesa, including llvmpipe on GPU-less hosts),
+//        falling back to the default EGL display. Nothing is drawn to a surface; see
+//        createHeadlessFramebuffer for the render target.
+// ===============================
+
+bool createHeadlessContext() {
+#ifdef POK3DEX_HEADLESS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+#endif
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "Headless: no EGL display available" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "Headless: no desktop OpenGL EGL config" << std::endl;
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Headless: could not create a surfaceless OpenGL 3.3 core context" << std::endl;
+        return false;
+    }
+    headlessDisplay = display;
+    headlessContext = context;
+    return true;
+#else
+    std::cerr << "--headless is not available: this build has no EGL support" << std::endl;
+    return false;
+#endif
+}
+
+// ===============================
+// Function: createHeadlessFramebuffer
+// Purpose: Creates the WIDTHxHEIGHT offscreen framebuffer that stands in for the window.
+// ===============================
+
+bool createHeadlessFramebuffer() {
+    GLuint color = 0, depth = 0;
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WIDTH, HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &screenFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Headless: offscreen framebuffer incomplete" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, WIDTH, HEIGHT);
+    return true;
+}
+
+// ===============================
+// Function: runHeadless
+// Purpose: Benchmarks loading and drawing without a window: every model in the range is
+//          loaded, fully streamed in, then drawn for a fixed number of frames through the
+//          normal display path into the offscreen framebuffer.
+// Parameters: firstId/lastId - model range, frames - frames rendered per model,
+//             jsonPath - per-species results file.
+// Returns: Process exit code.
+// Notes: Prints a table sorted by p99 frame time so the heaviest assets come first.
+// ===============================
+
+int runHeadless(int firstId, int lastId, int frames, const std::string& jsonPath) {
+    gameState = PLAYING;
+    playerName = "BENCH";
+    isSilhouette = false;   // Draw the textured path, the expensive one
+    isColorReveal = false;
+
+    std::vector<BenchResult> results;
+    std::vector<double> frameTimes(frames);
+    for (int id = firstId; id <= lastId; id++) {
+        auto loadStart = std::chrono::high_resolution_clock::now();
+        loadModel(id);
+        if (!pokemonModels.count(id)) continue;
+        BenchResult result;
+        result.id = id;
+        result.silhouetteMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - loadStart).count();
+        finishModelStream();
+        result.fullMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - loadStart).count();
+        result.load = modelLoadStats;
+        for (const MeshData& mesh : pokemonModels[id].meshes) result.triangles += mesh.indexCount / 3;
+        result.meshes = pokemonModels[id].meshes.size();
+
+        currentPokemonID = id;
+        rotationAngle = 0.0f;
+        for (int f = 0; f < frames; f++) {
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            display();
+            frameTimes[f] = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - frameStart).count();
+            rotationAngle = std::fmod(rotationAngle + ROTATION_SPEED / 60.0f, 360.0f);
+        }
+        result.drawCalls = frameDrawCalls;
+        for (double ms : frameTimes) result.meanFrameMs += ms;
+        result.meanFrameMs /= frames;
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        result.p99FrameMs = sorted[std::min((size_t)frames - 1, (size_t)(frames * 0.99))];
+        results.push_back(result);
+
+        unloadModel(id);
+    }
+
+    if (results.empty()) {
+        std::cerr << "Headless: no models loaded" << std::endl;
+        return 1;
+    }
+
+    // JSON, one object per species in ID order
+    std::ofstream json(jsonPath);
+    if (json) {
+        json << "{\n  \"frames\": " << frames << ",\n  \"models\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            std::string name;
+            for (char c : pokemonNames[r.id]) {
+                if (c == '"' || c == '\\') name += '\\';
+                name += c;
+            }
+            json << "    { \"id\": " << r.id << ", \"name\": \"" << name << "\""
+                << ", \"importMs\": " << r.load.importMs << ", \"geometryMs\": " << r.load.geometryMs
+                << ", \"attributesMs\": " << r.load.attributesMs << ", \"decodeMs\": " << r.load.decodeMs
+                << ", \"uploadMs\": " << r.load.uploadMs << ", \"silhouetteMs\": " << r.silhouetteMs
+                << ", \"fullMs\": " << r.fullMs << ", \"triangles\": " << r.triangles
+                << ", \"meshes\": " << r.meshes << ", \"drawCalls\": " << r.drawCalls
+                << ", \"textureBytes\": " << r.load.textureBytes << ", \"meanFrameMs\": " << r.meanFrameMs
+                << ", \"p99FrameMs\": " << r.p99FrameMs << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n}\n";
+        std::cout << "Benchmark results written to " << jsonPath << std::endl;
+    }
+    else {
+        std::cerr << "Could not write " << jsonPath << std::endl;
+    }
 
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    // Table, heaviest first
+    std::vector<BenchResult> byCost = results;
+    std::stable_sort(byCost.begin(), byCost.end(), [](const BenchResult& a, const BenchResult& b) {
+        return a.p99FrameMs > b.p99FrameMs;
+    });
+    char line[256];
+    snprintf(line, sizeof(line), "%4s %-12s %8s %8s %8s %8s %8s %9s %6s %8s %8s %8s",
+        "ID", "NAME", "IMPORT", "GEOM", "DECODE", "UPLOAD", "FULL", "TRIS", "DRAWS", "TEX KB", "MEAN", "P99");
+    std::cout << line << std::endl;
+    double totalFullMs = 0.0, totalFrameMs = 0.0;
+    for (const BenchResult& r : byCost) {
+        snprintf(line, sizeof(line), "%4d %-12.12s %8.2f %8.2f %8.2f %8.2f %8.2f %9zu %6u %8llu %8.3f %8.3f",
+            r.id, pokemonNames[r.id].c_str(), r.load.importMs, r.load.geometryMs, r.load.decodeMs,
+            r.load.uploadMs, r.fullMs, r.triangles, r.drawCalls,
+            (unsigned long long)(r.load.textureBytes / 1024), r.meanFrameMs, r.p99FrameMs);
+        std::cout << line << std::endl;
+        totalFullMs += r.fullMs;
+        totalFrameMs += r.meanFrameMs;
+    }
+    std::cout << "Headless summary: " << results.size() << " models, " << results.size() * 1000.0 / totalFullMs
+        << " models/s loaded, mean frame " << totalFrameMs / results.size() << " ms" << std::endl;
+    return 0;
 }
 
 // ===============================
@@ -1443,6 +5045,9 @@ void drawNameEntryScreen() {
 // ===============================
 
 int main(int argc, char** argv) {
+    appStartTime = std::chrono::high_resolution_clock::now();
+    std::string profileCsvPath;
+
     // Initialize game state
     gameState = START_SCREEN;
     playerName.clear();
@@ -1451,16 +5056,73 @@ int main(int argc, char** argv) {
     flashAlpha = 1.0f;
     flashDir = false;
 
+    // Headless runs must not touch GLUT, which needs a display
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless") headlessMode = true;
+    }
+    int benchFirst = 1, benchLast = 151, benchFrames = 120;
+    std::string benchJsonPath = "benchmark.json";
+
     // GLUT initialization
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_STENCIL);
-    glutInitWindowSize(WIDTH, HEIGHT);
-    glutCreateWindow("Pok3Dex");
-    glutPositionWindow(100, 100);
-    glutReshapeWindow(WIDTH, HEIGHT);
+    if (!headlessMode) glutInit(&argc, argv);
+
+    // Command-line options (GLUT has already removed its own arguments)
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--no-pbo-ring") usePboRing = false;
+        if (arg == "--no-dsa") useDirectStateAccess = false;
+        if (arg == "--capture-dir" && i + 1 < argc) captureDir = argv[++i];
+        if (arg == "--capture-frames" && i + 1 < argc) captureSequenceFrames = std::max(1, atoi(argv[++i]));
+        if (arg == "--text-stats") showTextStats = true;
+        if (arg == "--no-layer-cache") useCachedLayers = false;
+        if (arg == "--impostors") useImpostors = true;
+        if (arg == "--no-shader-cache") useProgramBinaryCache = false;
+        if (arg == "--dynamic-resolution") useDynamicResolution = true;
+        if (arg == "--gpu-budget" && i + 1 < argc) gpuBudgetMs = std::max(0.1, atof(argv[++i]));
+        if (arg == "--gallery") startInGallery = true;
+        if (arg == "--frame-stats") showFrameStats = true;
+        if (arg == "--fps" && i + 1 < argc) targetFps = std::max(0, atoi(argv[++i]));
+        if (arg == "--profile-csv" && i + 1 < argc) profileCsvPath = argv[++i];
+        if (arg == "--bench-frames" && i + 1 < argc) benchFrames = std::max(1, atoi(argv[++i]));
+        if (arg == "--bench-json" && i + 1 < argc) benchJsonPath = argv[++i];
+        if (arg == "--bench-models" && i + 1 < argc) {
+            // "N" or "first-last"
+            std::string range = argv[++i];
+            size_t dash = range.find('-');
+            benchFirst = std::max(1, atoi(range.substr(0, dash).c_str()));
+            benchLast = dash == std::string::npos ? benchFirst : std::min(151, atoi(range.substr(dash + 1).c_str()));
+        }
+        if (arg == "--build-manifest") {
+            buildAssetManifest();
+            return 0;
+        }
+    }
+    if (headlessMode) {
+        if (!createHeadlessContext()) return 1;
+    }
+    else {
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_STENCIL);
+        // Everything is drawn through shaders and VAOs, so ask for a 3.3 core profile context
+        glutInitContextVersion(3, 3);
+        glutInitContextProfile(GLUT_CORE_PROFILE);
+        glutInitWindowSize(WIDTH, HEIGHT);
+        glutCreateWindow("Pok3Dex");
+        glutPositionWindow(100, 100);
+        glutReshapeWindow(WIDTH, HEIGHT);
+    }
 
     // Critical: Initialize GLEW before any OpenGL operations
+    // (experimental mode is needed for GLEW to load entry points on a core profile)
+    glewExperimental = GL_TRUE;
+#ifdef POK3DEX_HEADLESS_EGL
+    // glewInit also sets up GLX, which needs an X display; only the GL entry points are needed
+    if (headlessMode) glewContextInit();
+    else glewInit();
+#else
     glewInit();
+#endif
+    glGetError();  // glewInit queries GL_EXTENSIONS, which raises a harmless error on core profiles
+    if (headlessMode && !createHeadlessFramebuffer()) return 1;
 
     // Verify OpenGL context
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
@@ -1471,47 +5133,71 @@ int main(int argc, char** argv) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
+    useMultiDrawIndirect = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+    useGpuCulling = useMultiDrawIndirect && GLEW_VERSION_4_3;
+    useIndirectCount = GLEW_ARB_indirect_parameters;
+    useDirectStateAccess = useDirectStateAccess && (GLEW_VERSION_4_5 ||
+        (GLEW_ARB_direct_state_access && GLEW_ARB_buffer_storage && GLEW_ARB_texture_storage));
+    std::cout << "Resource backend: " << (useDirectStateAccess ? "DSA, immutable storage" : "bind-to-edit")
+        << std::endl;
+    if (useProgramBinaryCache) initProgramBinaryCache();
+
+    // Texture upload ring must exist before the first loadTexture call
+    initPboRing();
+    initProfiler(profileCsvPath);
+    loadAssetManifest();
+
     // Load font FIRST before any textures/shaders
     std::cout << "Loading font...\n";
+    initSpriteBatcher();
+    if (useDynamicResolution) initDynamicResolution();
+    initTextRenderer();
     loadFont("assets/fonts/pokemon_gb.ttf");
-    if (characters.empty()) {
+    if (!fontLoaded) {
         std::cerr << "Font load failed!\n";
         return -1;
     }
     glFinish();  // Force GPU sync after font loading
 
     // Initialize shaders
-    shaderProgram = createShaderProgram("shaders/vertex.glsl", "shaders/fragment.glsl");
+    warmShaderVariants(modelShaders, { 0, MODEL_SHADER_TEXTURED, MODEL_SHADER_TEXTURED | MODEL_SHADER_REVEAL });
+    if (useImpostors) {
+        impostorProgram = createShaderProgram("shaders/sprite_vertex.glsl", "shaders/impostor_fragment.glsl");
+        glm::mat4 projection = glm::ortho(0.0f, (float)WIDTH, 0.0f, (float)HEIGHT);
+        glUseProgram(impostorProgram.id);
+        glUniformMatrix4fv(impostorProgram.uniform("projection"), 1, GL_FALSE, &projection[0][0]);
+        glUniform1i(impostorProgram.uniform("impostorAtlas"), 0);
+        glUniform3fv(impostorProgram.uniform("silhouetteColor"), 1, &SILHOUETTE_COLOR[0]);
+        createScreenQuadArray(impostor.vao, impostor.vbo);
+    }
     glUseProgram(0);  // Explicitly unbind shader
 
+    // Fixed camera: distance chosen so the model container fills half the view height
+    float camDist = (CAMERA_CONTAINER_H * 0.5f) / tan(glm::radians(CAMERA_FOV_Y) * 0.5f) * 2.0f;
+    initCameraBlock();
+    setCamera(glm::vec3(0, CAMERA_Y, camDist), glm::vec3(0, CAMERA_Y, 0), (float)WIDTH / HEIGHT);
+
     // Load textures
     startBg.id = loadTexture("assets/textures/start_bg.png");
     gameBg.id = loadTexture("assets/textures/game_bg.png");
     pokeballTex.id = loadTexture("assets/textures/pokeball.png");
 
+    if (headlessMode) {
+        int result = runHeadless(benchFirst, benchLast, benchFrames, benchJsonPath);
+        cleanup();
+        return result;
+    }
+
     // Sound initialization
     initSound();
+    if (startInGallery) enterGallery();
 
     // GLUT callbacks
-    glutDisplayFunc([]() {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Force fixed-function pipeline for text
-        glUseProgram(0);
-        glDisable(GL_LIGHTING);
-        glEnable(GL_TEXTURE_2D);
-
-        switch (gameState) {
-        case START_SCREEN: drawStartScreen(); break;
-        case NAME_ENTRY: drawNameEntryScreen(); break;
-        case PLAYING: drawGameScreen(); break;
-        case GAME_OVER: drawGameOverScreen(); break;
-        case WIN_SCREEN: drawWinScreen(); break;
-        }
-        glutSwapBuffers();
-        });
+    glutDisplayFunc(display);
 
     glutKeyboardFunc(keyboard);
+    glutSpecialFunc(specialKeys);
+    lastUpdateTime = GameClock::now();
     glutTimerFunc(0, update, 0);
 
     // Critical: Double-buffered initialization
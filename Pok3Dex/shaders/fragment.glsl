@@ -1,11 +1,27 @@
 #version 330 core
+// Variants (feature bits of modelShaders in main.cpp):
+//   TEXTURED - samples texture1; without it the mesh is drawn as a flat silhouette
+//   REVEAL   - blends the texture over the silhouette colour by "reveal"
 
+#ifdef TEXTURED
 in vec2 TexCoord;
-out vec4 FragColor;
-
 uniform sampler2D texture1;
+#endif
+#ifdef REVEAL
+uniform float reveal;            // 0 = flat silhouette, 1 = full texture colour
+#endif
+uniform vec3 silhouetteColor;
+
+out vec4 FragColor;
 
 void main()
 {
+#if defined(TEXTURED) && defined(REVEAL)
+    vec4 texColor = texture(texture1, TexCoord);
+    FragColor = vec4(mix(silhouetteColor, texColor.rgb, reveal), texColor.a);
+#elif defined(TEXTURED)
     FragColor = texture(texture1, TexCoord);
+#else
+    FragColor = vec4(silhouetteColor, 1.0);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 430 core
+layout(local_size_x = 64) in;
+
+// One gallery mesh: its model's bounding sphere and the index ranges of each LOD
+struct DrawRecord {
+    vec4 sphere;                 // xyz = world centre, w = radius
+    uint lodCount[4];
+    uint lodFirst[4];
+    int baseVertex;
+    uint baseInstance;
+    uint padding[2];
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Records { DrawRecord records[]; };
+layout(std430, binding = 1) writeonly buffer Commands { DrawCommand commands[]; };
+layout(binding = 0, offset = 0) uniform atomic_uint drawCount;
+
+uniform uint recordCount;
+uniform vec4 planes[6];          // Frustum planes, normals pointing inwards
+uniform vec3 eye;
+uniform float pixelsPerUnit;     // Projected pixels of a 1-unit object at distance 1
+uniform vec2 lodPixels;          // Below these projected diameters switch to LOD 1 / LOD 2
+uniform bool compact;            // Append survivors (draw count read from drawCount) or zero culled in place
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= recordCount) return;
+    DrawRecord record = records[i];
+
+    bool visible = true;
+    for (int p = 0; p < 6; p++) {
+        if (dot(planes[p].xyz, record.sphere.xyz) + planes[p].w < -record.sphere.w) visible = false;
+    }
+
+    float pixels = 2.0 * record.sphere.w * pixelsPerUnit / max(distance(eye, record.sphere.xyz), 0.001);
+    int lod = pixels < lodPixels.y ? 2 : (pixels < lodPixels.x ? 1 : 0);
+
+    DrawCommand command;
+    command.count = record.lodCount[lod];
+    command.instanceCount = visible ? 1u : 0u;
+    command.firstIndex = record.lodFirst[lod];
+    command.baseVertex = record.baseVertex;
+    command.baseInstance = record.baseInstance;
+    if (compact) {
+        if (visible) commands[atomicCounterIncrement(drawCount)] = command;
+    }
+    else {
+        commands[i] = command;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec2 TexCoord;
+flat in float Layer;
+out vec4 FragColor;
+
+uniform sampler2DArray textures;
+uniform vec3 untexturedColor;
+
+void main()
+{
+    if (Layer < 0.0) {
+        FragColor = vec4(untexturedColor, 1.0);
+        return;
+    }
+    FragColor = texture(textures, vec3(TexCoord, Layer));
+}
\ No newline at end of file
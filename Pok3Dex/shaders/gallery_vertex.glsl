@@ -0,0 +1,27 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 3) in mat4 aModel;     // Per draw: grid cell placement (locations 3-6)
+layout(location = 7) in float aLayer;    // Per draw: texture array layer (-1 = untextured)
+
+out vec2 TexCoord;
+flat out float Layer;
+
+uniform float spin;                      // Shared turntable angle (radians)
+
+// Shared camera matrices, updated only when the camera changes
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
+void main()
+{
+    // Every model spins in step, so the rotation is applied here and the per-draw data stays static
+    float c = cos(spin);
+    float s = sin(spin);
+    vec3 pos = vec3(c * aPos.x + s * aPos.z, aPos.y, c * aPos.z - s * aPos.x);
+    TexCoord = aTexCoord;
+    Layer = aLayer;
+    gl_Position = projection * view * aModel * vec4(pos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D impostorAtlas;
+uniform float reveal;            // Same meaning as in fragment.glsl
+uniform vec3 silhouetteColor;
+
+void main()
+{
+    // Views are captured in full colour; the silhouette only needs their coverage
+    vec4 view = texture(impostorAtlas, TexCoord);
+    FragColor = vec4(mix(silhouetteColor, view.rgb, reveal), view.a * Color.a);
+}
\ No newline at end of file
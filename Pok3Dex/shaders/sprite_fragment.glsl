@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D spriteTexture;
+
+void main()
+{
+    // Solid quads sample a 1x1 white texture, so the tint alone gives their colour
+    FragColor = texture(spriteTexture, TexCoord) * Color;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D glyphAtlas;
+
+void main()
+{
+    // Atlas stores a signed distance field: 0.5 is the glyph edge.
+    // fwidth keeps the edge one screen pixel wide at any text scale.
+    float dist = texture(glyphAtlas, TexCoord).r;
+    float edge = max(fwidth(dist), 0.0001);
+    float coverage = smoothstep(0.5 - edge, 0.5 + edge, dist);
+    FragColor = vec4(Color.rgb, Color.a * coverage);
+}
\ No newline at end of file
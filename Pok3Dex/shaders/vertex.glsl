@@ -3,14 +3,22 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoord;
 layout(location = 2) in vec3 aNormal;
 
+#ifdef TEXTURED
 out vec2 TexCoord;
+#endif
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Shared camera matrices, updated only when the camera changes
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
 
 void main()
 {
+#ifdef TEXTURED
     TexCoord = aTexCoord;
+#endif
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file